@@ -0,0 +1,326 @@
+/*
+ * IdleManager.cpp
+ *
+ * Implementation of the IdleManager class.
+ * Uses the AVR sleep modes and the watchdog timer to idle between ticks.
+ */
+
+#include "IdleManager.h"
+#include "WatchdogHook.h"
+
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+
+// Counters maintained by the Arduino core (wiring.c): millis() and the
+// Timer0 overflows that micros() is built from
+extern volatile unsigned long timer0_millis;
+extern volatile unsigned long timer0_overflow_count;
+
+// One Timer0 overflow: 256 ticks with the core's prescaler of 64
+static const unsigned long OVERFLOW_US = 64UL * 256 / (F_CPU / 1000000UL);
+
+// Watchdog prescaler settings 0-9: 2K-1024K cycles of the 128 kHz
+// watchdog oscillator, i.e. 16 ms - 8 s nominal, each twice the last.
+// (The WDTO_15MS ... names round these down.)
+static const int WDT_LONGEST = WDTO_8S;
+static const unsigned long NOMINAL_WATCHDOG_US = 16000;
+
+// Oscillator start-up after power-down: 16K CPU cycles (Uno fuses)
+static const unsigned long WAKE_STARTUP_US = 16384UL * 1000 / (F_CPU / 1000);
+
+static uint8_t watchdogBits(uint8_t setting) {
+  return (setting & 0x07) | ((setting & 0x08) ? _BV(WDP3) : 0);
+}
+#endif
+
+// Set by the watchdog interrupt: the period being slept out has ended.
+// Other watchdog users (Stage 3's DeadlineMonitor) may re-arm WDIE in their own
+// handler, so WDIE itself cannot show this.
+static volatile bool watchdogFired = false;
+
+static void onWatchdog() {
+  watchdogFired = true;
+}
+
+IdleManager::IdleManager() {
+  taskCount = 0;
+  activeMs = 0;
+  sleepMs = 0;
+  lastWakeMs = 0;
+  worstLatencyMs = 0;
+  watchdogUs = 16000;  // Nominal until the first calibration
+  calibrated = false;
+  powerDownsSinceCalibration = 0;
+  correctionUs = 0;
+  earlyWakes = 0;
+  maxPowerDownUs = 0;
+  maxLateMs = 0;
+  overflowCorrectionUs = 0;
+  WatchdogHook::add(onWatchdog);
+}
+
+int IdleManager::addTask(unsigned long period) {
+  if (taskCount >= MAX_TASKS) {
+    return -1;  // Task table full
+  }
+
+  periodMs[taskCount] = period;
+  nextDueMs[taskCount] = millis();  // First run is due immediately
+  return taskCount++;
+}
+
+bool IdleManager::isDue(int id) {
+  if (id < 0 || id >= taskCount) return false;
+
+  unsigned long now = millis();
+  if ((long)(now - nextDueMs[id]) < 0) {
+    return false;
+  }
+
+  nextDueMs[id] += periodMs[id];
+  if ((long)(now - nextDueMs[id]) >= 0) {
+    // Fell more than a period behind - resynchronize instead of bursting
+    nextDueMs[id] = now + periodMs[id];
+  }
+  return true;
+}
+
+unsigned long IdleManager::msUntilNextTask() {
+  if (taskCount == 0) return 0;
+
+  unsigned long now = millis();
+  long earliest = (long)(nextDueMs[0] - now);
+  for (int i = 1; i < taskCount; i++) {
+    long remaining = (long)(nextDueMs[i] - now);
+    if (remaining < earliest) {
+      earliest = remaining;
+    }
+  }
+  return (earliest > 0) ? (unsigned long)earliest : 0;
+}
+
+void IdleManager::sleepUntilNextTask(bool keepClocksRunning) {
+  unsigned long now = millis();
+  activeMs += now - lastWakeMs;
+
+  unsigned long remaining = msUntilNextTask();
+  unsigned long wakeAtMs = now + remaining;
+  unsigned long powerDownUs = 0;
+
+  if (remaining > 0) {
+#if defined(__AVR__)
+    if (!keepClocksRunning) {
+      // Power down in watchdog-sized chunks while one still fits
+      while ((long)(wakeAtMs - millis()) > 0) {
+        unsigned long leftUs = (wakeAtMs - millis()) * 1000UL;
+        if (!calibrated || powerDownsSinceCalibration >= CALIBRATION_INTERVAL) {
+          if (!calibrateWatchdog(leftUs)) break;
+        } else {
+          unsigned long sleptUs = powerDown(leftUs);
+          if (sleptUs == 0) break;
+          powerDownUs += sleptUs;
+        }
+      }
+    }
+    sleepIdle(wakeAtMs);  // Remainder (or everything) in idle mode
+#else
+    (void)keepClocksRunning;
+    delay(remaining);     // No sleep support: fall back to busy-wait
+#endif
+  }
+
+  unsigned long woke = millis();
+  sleepMs += woke - now;
+  lastWakeMs = woke;
+
+  // Lateness of this wake-up relative to the task deadline. The idle
+  // phase runs on Timer0, so this part is exact; the power-down part is
+  // checked when the watchdog is next calibrated.
+  if ((long)(woke - wakeAtMs) > 0) {
+    unsigned long lateMs = woke - wakeAtMs;
+    if (lateMs > worstLatencyMs) worstLatencyMs = lateMs;
+    if (lateMs > maxLateMs) maxLateMs = lateMs;
+  }
+  if (powerDownUs > maxPowerDownUs) {
+    maxPowerDownUs = powerDownUs;
+  }
+}
+
+void IdleManager::sleepIdle(unsigned long wakeAtMs) {
+#if defined(__AVR__)
+  // Timers keep running; the Timer0 overflow wakes us every ~1 ms
+  set_sleep_mode(SLEEP_MODE_IDLE);
+  while ((long)(wakeAtMs - millis()) > 0) {
+    sleep_mode();
+  }
+#else
+  (void)wakeAtMs;
+#endif
+}
+
+unsigned long IdleManager::powerDown(unsigned long maxUs) {
+#if defined(__AVR__)
+  // Pick the longest watchdog period that does not overshoot, with a 1/32
+  // margin for oscillator drift since the last calibration
+  int setting = WDT_LONGEST;
+  unsigned long expectedUs = 0;
+  for (; setting >= 0; setting--) {
+    expectedUs = (watchdogUs << setting) + WAKE_STARTUP_US;
+    if (expectedUs + expectedUs / 32 <= maxUs) break;
+  }
+  if (setting < 0) return 0;
+
+  uint8_t oldSREG = SREG;
+  cli();
+
+  // Save the current watchdog setup to restore later
+  uint8_t savedWdt = WDTCSR & ~_BV(WDCE);
+
+  // Interrupt-and-reset mode: should the wake-up interrupt ever be lost,
+  // the next timeout resets the board instead of sleeping forever
+  wdt_reset();
+  WDTCSR = _BV(WDCE) | _BV(WDE);
+  WDTCSR = _BV(WDIE) | _BV(WDE) | watchdogBits(setting);
+  watchdogFired = false;
+
+  uint8_t savedAdc = ADCSRA;
+  ADCSRA &= ~_BV(ADEN);  // The ADC draws current even in power-down
+
+  set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+  while (!watchdogFired) {
+    sleep_enable();
+    sei();        // The instruction after sei() always runs before an interrupt
+    sleep_cpu();  // ... so the wake-up interrupt cannot be missed
+    sleep_disable();
+    cli();
+    if (!watchdogFired) {
+      earlyWakes++;  // Another interrupt woke us: sleep out the period
+    }
+  }
+
+  ADCSRA = savedAdc;
+
+  wdt_reset();
+  WDTCSR = _BV(WDCE) | _BV(WDE);
+  WDTCSR = savedWdt;
+
+  // millis() and micros() stood still while powered down - add the
+  // slept time back to both
+  correctionUs += expectedUs;
+  timer0_millis += correctionUs / 1000;
+  correctionUs %= 1000;
+  overflowCorrectionUs += expectedUs;
+  timer0_overflow_count += overflowCorrectionUs / OVERFLOW_US;
+  overflowCorrectionUs %= OVERFLOW_US;
+  SREG = oldSREG;
+
+  powerDownsSinceCalibration++;
+  return expectedUs;
+#else
+  (void)maxUs;
+  return 0;
+#endif
+}
+
+bool IdleManager::calibrateWatchdog(unsigned long maxUs) {
+#if defined(__AVR__)
+  // One shortest period, even with a 10% slow oscillator, must fit
+  if (maxUs < watchdogUs + watchdogUs / 8) return false;
+
+  uint8_t oldSREG = SREG;
+  cli();
+  uint8_t savedWdt = WDTCSR & ~_BV(WDCE);
+
+  wdt_reset();
+  WDTCSR = _BV(WDCE) | _BV(WDE);
+  WDTCSR = _BV(WDIE) | _BV(WDE);  // Shortest period, interrupt-and-reset mode
+  watchdogFired = false;
+  unsigned long startUs = micros();
+
+  // Idle mode keeps Timer0 running, so micros() times the period exactly
+  set_sleep_mode(SLEEP_MODE_IDLE);
+  while (!watchdogFired) {
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+    cli();
+  }
+  unsigned long measuredUs = micros() - startUs;
+
+  wdt_reset();
+  WDTCSR = _BV(WDCE) | _BV(WDE);
+  WDTCSR = savedWdt;
+  SREG = oldSREG;
+
+  // Ignore implausible results (e.g. interrupts held off for too long)
+  if (measuredUs < NOMINAL_WATCHDOG_US / 2 || measuredUs > NOMINAL_WATCHDOG_US * 2) {
+    return true;
+  }
+
+  if (calibrated && measuredUs > watchdogUs) {
+    // The watchdog got slower: the power-downs since the last calibration
+    // were longer than what was added to millis(), so they woke up late
+    // (rounded up: this is a bound, not an estimate)
+    float drift = (float)(measuredUs - watchdogUs) / watchdogUs;
+    unsigned long lateMs = maxLateMs + (unsigned long)(maxPowerDownUs * drift / 1000.0 + 0.999);
+    if (lateMs > worstLatencyMs) {
+      worstLatencyMs = lateMs;
+    }
+  }
+
+  watchdogUs = measuredUs;
+  calibrated = true;
+  powerDownsSinceCalibration = 0;
+  maxPowerDownUs = 0;
+  maxLateMs = 0;
+  return true;
+#else
+  (void)maxUs;
+  return false;
+#endif
+}
+
+unsigned long IdleManager::getActiveMs() {
+  return activeMs;
+}
+
+unsigned long IdleManager::getSleepMs() {
+  return sleepMs;
+}
+
+int IdleManager::getActivePercent() {
+  unsigned long total = activeMs + sleepMs;
+  if (total == 0) return 100;
+  return (int)(100.0 * activeMs / total);
+}
+
+unsigned long IdleManager::getWorstWakeLatencyMs() {
+  return worstLatencyMs;
+}
+
+unsigned long IdleManager::getWatchdogPeriodUs() {
+  return watchdogUs;
+}
+
+unsigned long IdleManager::getEarlyWakes() {
+  return earlyWakes;
+}
+
+void IdleManager::printReport(Print& out) {
+  out.print("Duty cycle: ");
+  out.print(getActivePercent());
+  out.print("% active (active=");
+  out.print(activeMs);
+  out.print("ms sleep=");
+  out.print(sleepMs);
+  out.print("ms) worst wake latency=");
+  out.print(worstLatencyMs);
+  out.println("ms");
+  out.print("Watchdog: 16ms period measured as ");
+  out.print(watchdogUs);
+  out.print("us, early wakes=");
+  out.println(earlyWakes);
+}
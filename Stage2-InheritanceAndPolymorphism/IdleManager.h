@@ -0,0 +1,120 @@
+/*
+ * IdleManager.h
+ *
+ * Low-power idle between control ticks.
+ * Replaces busy-wait delay() with real sleep: the manager keeps a small
+ * table of periodic tasks, computes the time until the next one is due
+ * and sleeps as deeply as the hardware allows until then.
+ *
+ * Sleep depth:
+ * - IDLE mode when clocks must keep running (PWM outputs, Servo pulses,
+ *   Serial receive). The CPU stops, timers keep running, and the
+ *   millis() timer interrupt wakes the CPU about every millisecond.
+ * - POWER-DOWN otherwise, woken by the watchdog timer in chunks of
+ *   16 ms - 8 s. millis() and micros() stop in power-down, so the slept
+ *   time is added back to both afterwards to keep schedules correct.
+ *
+ * Power-down timekeeping:
+ * - The watchdog runs from its own 128 kHz oscillator, which is only
+ *   accurate to about +/-10% (supply voltage, temperature). Its period
+ *   is therefore measured against Timer0 (calibrated) before the first
+ *   power-down and again every CALIBRATION_INTERVAL power-downs.
+ * - Waking from power-down takes 16K CPU cycles (1 ms at 16 MHz) of
+ *   oscillator start-up; that time is added as well.
+ * - Another interrupt (e.g. a pin change) can wake the CPU before the
+ *   watchdog does. The slept time would then be unknown, so the manager
+ *   goes back to sleep until the watchdog period has ended.
+ * - Wake latency is the lateness measured while Timer0 runs, plus the
+ *   power-down error that each recalibration reveals: if the watchdog got
+ *   slower, the power-downs since the last calibration lasted longer than
+ *   was added to millis(), and those wake-ups were late by that much.
+ *
+ * Hardware: Sleep modes are AVR-specific (Arduino Uno). On other boards
+ * the manager falls back to delay() so sketches still run unchanged.
+ * The watchdog interrupt comes through WatchdogHook, which must be in
+ * the sketch folder too.
+ *
+ * The same two files are in Stages 2, 3 and 4 (Arduino sketches cannot
+ * share source folders); Tools/HostTests checks that the copies match.
+ */
+
+#ifndef IDLEMANAGER_H
+#define IDLEMANAGER_H
+
+#include <Arduino.h>
+
+class IdleManager {
+  public:
+    static const int MAX_TASKS = 4;  // Fixed-size task table (no heap)
+    static const unsigned int CALIBRATION_INTERVAL = 32;  // Power-downs between calibrations
+
+  private:
+    unsigned long periodMs[MAX_TASKS];  // Task periods
+    unsigned long nextDueMs[MAX_TASKS]; // Next due time per task
+    int taskCount;
+
+    // Duty-cycle accounting
+    unsigned long activeMs;       // Time spent awake
+    unsigned long sleepMs;        // Time spent asleep (idle or power-down)
+    unsigned long lastWakeMs;     // When the CPU last woke up
+    unsigned long worstLatencyMs; // Worst lateness of a wake-up vs. due time
+
+    // Power-down timekeeping
+    unsigned long watchdogUs;     // Measured shortest watchdog period (nominal 16 ms)
+    bool calibrated;
+    unsigned int powerDownsSinceCalibration;
+    unsigned long correctionUs;   // Slept time not yet added to millis()
+    unsigned long overflowCorrectionUs; // ... not yet added to micros()
+    unsigned long earlyWakes;     // Wakes by other interrupts (slept on)
+    unsigned long maxPowerDownUs; // Longest power-down of one wake-up since calibration
+    unsigned long maxLateMs;      // Worst measured lateness since calibration
+
+    void sleepIdle(unsigned long wakeAtMs);
+    unsigned long powerDown(unsigned long maxUs);
+    bool calibrateWatchdog(unsigned long maxUs);
+
+  public:
+    // Constructor
+    IdleManager();
+
+    // Declare a periodic task; returns its id, or -1 if the table is full
+    int addTask(unsigned long period);
+
+    // True once per period for the given task (reschedules it)
+    bool isDue(int id);
+
+    // Milliseconds until the earliest task is due (0 if one is due now)
+    unsigned long msUntilNextTask();
+
+    // Sleep until the next task is due
+    // keepClocksRunning: true while PWM, Servo or Serial receive are in use
+    void sleepUntilNextTask(bool keepClocksRunning);
+
+    // Statistics
+    unsigned long getActiveMs();
+    unsigned long getSleepMs();
+    int getActivePercent();            // Active share of total time (0-100)
+    unsigned long getWorstWakeLatencyMs();
+    unsigned long getWatchdogPeriodUs(); // Shortest watchdog period (measured)
+    unsigned long getEarlyWakes();
+
+    // Print active vs. sleep duty cycle (e.g. to Serial)
+    void printReport(Print& out);
+};
+
+/*
+ * Usage:
+ *
+ *   IdleManager idle;
+ *   int readTask = idle.addTask(2000);  // Every 2 seconds
+ *
+ *   void loop() {
+ *     if (idle.isDue(readTask)) {
+ *       // ... periodic work ...
+ *     }
+ *     Serial.flush();                    // Finish sending before sleeping
+ *     idle.sleepUntilNextTask(false);    // No PWM/Servo: power-down is safe
+ *   }
+ */
+
+#endif
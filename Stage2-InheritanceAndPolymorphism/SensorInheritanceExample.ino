@@ -15,22 +15,20 @@
 #include "TemperatureSensor.h"
 #include "LightSensor.h"
 #include "UltrasonicSensor.h"
+#include "IdleManager.h"
 
 // Array of base class pointers demonstrating polymorphism
 const int NUM_SENSORS = 3;
 Sensor* sensors[NUM_SENSORS];
 
+// Sleep between readings instead of busy-waiting in delay()
+IdleManager idle;
+int readTask = -1;
+const unsigned long READ_PERIOD_MS = 2000;  // Read every 2 seconds
+const unsigned long SERIAL_WAIT_MS = 2000;  // Give up waiting for a host after 2 s
+
 void setup() {
-    Serial.begin(9600);
-    while (!Serial) {
-        ; // Wait for serial port to connect (needed for some boards)
-    }
-    
-    Serial.println("=================================");
-    Serial.println("Sensor Inheritance Example");
-    Serial.println("Demonstrating Polymorphism");
-    Serial.println("=================================\n");
-    
+    // Hardware first: configure the sensor pins before waiting on Serial
     // Create sensor objects using base class pointers
     // This demonstrates runtime polymorphism
     sensors[0] = new TemperatureSensor(A0);
@@ -39,33 +37,51 @@ void setup() {
     
     // Initialize all sensors polymorphically
     // Each sensor's specific begin() method is called
-    Serial.println("Initializing sensors...");
     for (int i = 0; i < NUM_SENSORS; ++i) {
         sensors[i]->begin();
     }
+    
+    // Bounded wait: boards without a connected host still start reading
+    Serial.begin(9600);
+    while (!Serial && millis() < SERIAL_WAIT_MS) {
+        ; // Wait for serial port to connect (needed for some boards)
+    }
+    
+    Serial.println("=================================");
+    Serial.println("Sensor Inheritance Example");
+    Serial.println("Demonstrating Polymorphism");
+    Serial.println("=================================\n");
     Serial.println("All sensors initialized!\n");
-    delay(1000);
+    
+    readTask = idle.addTask(READ_PERIOD_MS);
 }
 
 void loop() {
-    Serial.println("--- Sensor Readings ---");
-    
-    // Polymorphic call to readValue()
-    // The actual method executed depends on the runtime type of each object
-    Serial.print("Temperature Sensor: ");
-    Serial.print(sensors[0]->readValue());
-    Serial.println(" V");
-    
-    Serial.print("Light Sensor: ");
-    Serial.print(sensors[1]->readValue());
-    Serial.println(" %");
-    
-    Serial.print("Ultrasonic Sensor: ");
-    Serial.print(sensors[2]->readValue());
-    Serial.println(" cm");
+    if (idle.isDue(readTask)) {
+        Serial.println("--- Sensor Readings ---");
+        
+        // Polymorphic call to readValue()
+        // The actual method executed depends on the runtime type of each object
+        Serial.print("Temperature Sensor: ");
+        Serial.print(sensors[0]->readValue());
+        Serial.println(" V");
+        
+        Serial.print("Light Sensor: ");
+        Serial.print(sensors[1]->readValue());
+        Serial.println(" %");
+        
+        Serial.print("Ultrasonic Sensor: ");
+        Serial.print(sensors[2]->readValue());
+        Serial.println(" cm");
+        
+        idle.printReport(Serial);
+        Serial.println();
+    }
     
-    Serial.println();
-    delay(2000);  // Wait 2 seconds before next reading
+    // No actuators here, so the board can power down until the next reading.
+    // Finish sending first: the UART stops while powered down.
+    Serial.flush();
+    idle.sleepUntilNextTask(false);
 }
 
 /*
@@ -0,0 +1,53 @@
+/*
+ * WatchdogHook.cpp
+ *
+ * Implementation of the WatchdogHook class and the watchdog ISR.
+ */
+
+#include <Arduino.h>
+#include "WatchdogHook.h"
+
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#endif
+
+// Zero-initialized before any constructor runs, so global objects can
+// register from their constructors
+static WatchdogHook::Handler handlers[WatchdogHook::MAX_HANDLERS];
+static volatile int handlerCount = 0;
+
+bool WatchdogHook::add(Handler handler) {
+  if (handler == nullptr) return false;
+
+  bool added = false;
+#if defined(__AVR__)
+  uint8_t oldSREG = SREG;
+  cli();  // The interrupt walks this table
+#endif
+  bool known = false;
+  for (int i = 0; i < handlerCount; i++) {
+    if (handlers[i] == handler) known = true;
+  }
+  if (known) {
+    added = true;
+  } else if (handlerCount < MAX_HANDLERS) {
+    handlers[handlerCount++] = handler;
+    added = true;
+  }
+#if defined(__AVR__)
+  SREG = oldSREG;
+#endif
+  return added;
+}
+
+void WatchdogHook::dispatch() {
+  for (int i = 0; i < handlerCount; i++) {
+    handlers[i]();
+  }
+}
+
+#if defined(__AVR__)
+ISR(WDT_vect) {
+  WatchdogHook::dispatch();
+}
+#endif
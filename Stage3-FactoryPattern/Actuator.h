@@ -14,6 +14,31 @@
 
 #include <Arduino.h>
 
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#endif
+
+// Critical section for actuator state and output pins.
+// DeadlineMonitor's watchdog interrupt may call deactivate() while the
+// main program is inside setValue() or activate(). Without the lock,
+// setValue() could check "active", be interrupted by the shutdown, and
+// then restore the PWM output. The lock saves and restores the interrupt
+// flag, so it can also be taken inside the interrupt itself.
+class ActuatorLock {
+  private:
+#if defined(__AVR__)
+    uint8_t oldSREG;
+  public:
+    ActuatorLock() : oldSREG(SREG) { cli(); }
+    ~ActuatorLock() { SREG = oldSREG; }
+#else
+    // The watchdog path is AVR only, so this is never taken inside an ISR
+  public:
+    ActuatorLock() { noInterrupts(); }
+    ~ActuatorLock() { interrupts(); }
+#endif
+};
+
 class Actuator {
   public:
     // Pure virtual functions - must be implemented by derived classes
@@ -22,6 +47,8 @@ class Actuator {
     virtual void activate() = 0;
     
     // Stop and cleanup the actuator
+    // May run inside the watchdog interrupt (see DeadlineMonitor.h):
+    // must not block, and must update state and outputs under ActuatorLock
     virtual void deactivate() = 0;
     
     // Set the actuator value (speed, angle, power, etc.)
@@ -0,0 +1,101 @@
+/*
+ * BootSequencer.cpp
+ *
+ * Implementation of the BootSequencer class.
+ */
+
+#include "BootSequencer.h"
+
+BootSequencer::BootSequencer() {
+  criticalCount = 0;
+  backgroundCount = 0;
+  currentBackground = 0;
+  firstControlUs = 0;
+  completeMs = 0;
+}
+
+bool BootSequencer::addCritical(const char* name, CriticalStep step) {
+  if (step == nullptr || criticalCount >= MAX_STEPS) {
+    return false;
+  }
+  criticalNames[criticalCount] = name;
+  criticalSteps[criticalCount] = step;
+  criticalCount++;
+  return true;
+}
+
+bool BootSequencer::addBackground(const char* name, BackgroundStep step) {
+  if (step == nullptr || backgroundCount >= MAX_STEPS) {
+    return false;
+  }
+  backgroundNames[backgroundCount] = name;
+  backgroundSteps[backgroundCount] = step;
+  backgroundCount++;
+  return true;
+}
+
+void BootSequencer::runCritical() {
+  for (int i = 0; i < criticalCount; i++) {
+    criticalSteps[i]();
+  }
+  firstControlUs = micros();  // Actuators are now in a defined state
+}
+
+void BootSequencer::service() {
+  if (isComplete()) return;
+
+  if (backgroundSteps[currentBackground]()) {
+    currentBackground++;
+    if (isComplete()) {
+      completeMs = millis();
+    }
+  }
+}
+
+bool BootSequencer::isComplete() {
+  return currentBackground >= backgroundCount;
+}
+
+const char* BootSequencer::getCurrentStepName() {
+  return isComplete() ? "done" : backgroundNames[currentBackground];
+}
+
+unsigned long BootSequencer::getTimeToFirstControlUs() {
+  return firstControlUs;
+}
+
+bool BootSequencer::metBudget(unsigned long budgetUs) {
+  return firstControlUs <= budgetUs;
+}
+
+unsigned long BootSequencer::getCompleteMs() {
+  return completeMs;
+}
+
+void BootSequencer::printReport(Print& out, unsigned long budgetUs) {
+  out.print("Boot: first control after ");
+  out.print(firstControlUs);
+  out.print("us (budget ");
+  out.print(budgetUs);
+  out.print("us, ");
+  out.print(metBudget(budgetUs) ? "OK" : "OVER");
+  out.println(")");
+
+  out.print("Critical steps:");
+  for (int i = 0; i < criticalCount; i++) {
+    out.print(" ");
+    out.print(criticalNames[i]);
+  }
+  out.println();
+
+  out.print("Background: ");
+  if (isComplete()) {
+    out.print("done after ");
+    out.print(completeMs);
+    out.println("ms");
+  } else {
+    out.print("running '");
+    out.print(getCurrentStepName());
+    out.println("'");
+  }
+}
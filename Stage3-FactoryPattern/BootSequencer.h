@@ -0,0 +1,79 @@
+/*
+ * BootSequencer.h
+ *
+ * Fast-boot startup path with deferred initialization.
+ *
+ * After a reset (for example a brown-out), actuator pins must reach a
+ * defined state before anything slow happens. The sequencer splits
+ * start-up into two phases:
+ * - CRITICAL steps run immediately in setup(), in the order they were
+ *   added (e.g. create actuators in their safe "off" state, arm the
+ *   deadline watchdog).
+ * - BACKGROUND steps run afterwards from loop(), one slice per call,
+ *   so waiting for the Serial port, demos and diagnostics never keep
+ *   the control loop from running.
+ *
+ * The time from reset to the end of the critical phase is recorded as
+ * "time to first control" and can be checked against a budget.
+ */
+
+#ifndef BOOTSEQUENCER_H
+#define BOOTSEQUENCER_H
+
+#include <Arduino.h>
+
+class BootSequencer {
+  public:
+    static const int MAX_STEPS = 6;      // Per phase; fixed size (no heap)
+
+    typedef void (*CriticalStep)();      // Runs once, must not block
+    typedef bool (*BackgroundStep)();    // Returns true when finished
+
+  private:
+    const char* criticalNames[MAX_STEPS];
+    CriticalStep criticalSteps[MAX_STEPS];
+    int criticalCount;
+
+    const char* backgroundNames[MAX_STEPS];
+    BackgroundStep backgroundSteps[MAX_STEPS];
+    int backgroundCount;
+    int currentBackground;               // Index of the running background step
+
+    unsigned long firstControlUs;        // micros() when the critical phase ended
+    unsigned long completeMs;            // millis() when the last background step ended
+
+  public:
+    // Constructor
+    BootSequencer();
+
+    // Register steps; return false if the phase is full
+    bool addCritical(const char* name, CriticalStep step);
+    bool addBackground(const char* name, BackgroundStep step);
+
+    // Run all critical steps now (call at the top of setup())
+    void runCritical();
+
+    // Run one slice of the current background step (call from loop())
+    void service();
+
+    // True once every background step has finished
+    bool isComplete();
+
+    // Name of the running background step ("done" when complete)
+    const char* getCurrentStepName();
+
+    // Boot metrics
+    unsigned long getTimeToFirstControlUs();
+    bool metBudget(unsigned long budgetUs);
+    unsigned long getCompleteMs();
+
+    // Print boot metrics (e.g. to Serial)
+    void printReport(Print& out, unsigned long budgetUs);
+};
+
+/*
+ * Note: micros() starts counting when the Arduino core initializes,
+ * so time to first control excludes the bootloader delay.
+ */
+
+#endif
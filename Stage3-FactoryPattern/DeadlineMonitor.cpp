@@ -0,0 +1,222 @@
+/*
+ * DeadlineMonitor.cpp
+ *
+ * Implementation of the DeadlineMonitor class.
+ * Measures task execution time with micros() and shuts down all
+ * registered actuators when deadlines keep being missed.
+ */
+
+#include "DeadlineMonitor.h"
+#include "WatchdogHook.h"
+
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#include <avr/wdt.h>
+#endif
+
+// Monitor serviced by the watchdog interrupt (set by armWatchdog())
+static DeadlineMonitor* watchdogMonitor = nullptr;
+
+// Watchdog path: runs even when loop() is stuck inside a blocking call
+static void onWatchdog() {
+  if (watchdogMonitor != nullptr) {
+    watchdogMonitor->watchdogCheck();
+  }
+#if defined(__AVR__)
+  // The hardware cleared WDIE to run this interrupt: without it, the next
+  // timeout resets the board
+  WDTCSR |= _BV(WDIE);
+#endif
+}
+
+DeadlineMonitor::DeadlineMonitor(unsigned int limit) {
+  taskCount = 0;
+  actuatorCount = 0;
+  missLimit = (limit == 0) ? 1 : limit;
+  activeTask = -1;
+  activeStartUs = 0;
+  failSafeTripped = false;
+  tripCount = 0;
+}
+
+int DeadlineMonitor::addTask(const char* name, unsigned long budgetUs) {
+  if (taskCount >= MAX_TASKS) {
+    return -1;  // Task table full
+  }
+
+  TaskStats& task = tasks[taskCount];
+  task.name = name;
+  task.budgetUs = budgetUs;
+  task.runs = 0;
+  task.overruns = 0;
+  task.worstUs = 0;
+  task.consecutiveMisses = 0;
+  return taskCount++;
+}
+
+bool DeadlineMonitor::registerActuator(Actuator* actuator) {
+  if (actuator == nullptr || actuatorCount >= MAX_ACTUATORS) {
+    return false;
+  }
+
+  noInterrupts();  // The watchdog interrupt walks this list
+  actuators[actuatorCount++] = actuator;
+  interrupts();
+  return true;
+}
+
+void DeadlineMonitor::unregisterActuator(Actuator* actuator) {
+  noInterrupts();
+  for (int i = 0; i < actuatorCount; i++) {
+    if (actuators[i] == actuator) {
+      // Shift the rest down to keep the shutdown order intact
+      for (int j = i; j < actuatorCount - 1; j++) {
+        actuators[j] = actuators[j + 1];
+      }
+      actuatorCount--;
+      break;
+    }
+  }
+  interrupts();
+}
+
+void DeadlineMonitor::beginTask(int id) {
+  if (id < 0 || id >= taskCount) return;
+
+  noInterrupts();  // 32-bit writes are not atomic on AVR
+  activeStartUs = micros();
+  activeTask = id;
+  interrupts();
+}
+
+void DeadlineMonitor::endTask(int id) {
+  if (id < 0 || id >= taskCount) return;
+
+  // The watchdog interrupt also writes consecutiveMisses, so the whole
+  // update runs with interrupts off (a few dozen cycles)
+  bool trip = false;
+  noInterrupts();
+  unsigned long elapsed = micros() - activeStartUs;
+  activeTask = -1;
+
+  TaskStats& task = tasks[id];
+  task.runs++;
+  if (elapsed > task.worstUs) {
+    task.worstUs = elapsed;
+  }
+
+  if (elapsed > task.budgetUs) {
+    task.overruns++;
+    task.consecutiveMisses++;
+  } else {
+    task.consecutiveMisses = 0;  // A good run clears the streak
+  }
+
+  // Latch the fail-safe exactly once, even if the watchdog races us
+  if (!failSafeTripped && task.consecutiveMisses >= missLimit) {
+    failSafeTripped = true;
+    trip = true;
+  }
+  interrupts();
+
+  if (trip) {
+    tripFailSafe();
+  }
+}
+
+void DeadlineMonitor::watchdogCheck() {
+  // Runs with interrupts disabled when called from the watchdog ISR
+  if (failSafeTripped) return;
+
+  int id = activeTask;
+  if (id < 0) return;  // Between runs - nothing can be stuck
+
+  // A task stuck for missLimit budgets counts as missLimit misses
+  // (divided, not multiplied: budgetUs * missLimit can overflow)
+  unsigned long elapsed = micros() - activeStartUs;
+  if (elapsed / missLimit >= tasks[id].budgetUs) {
+    tasks[id].consecutiveMisses = missLimit;
+    failSafeTripped = true;
+    tripFailSafe();
+  }
+}
+
+void DeadlineMonitor::tripFailSafe() {
+  // Callers have already latched failSafeTripped, so this runs once
+  tripCount++;
+  for (int i = 0; i < actuatorCount; i++) {
+    actuators[i]->deactivate();
+  }
+}
+
+void DeadlineMonitor::armWatchdog() {
+  watchdogMonitor = this;
+  WatchdogHook::add(onWatchdog);
+
+#if defined(__AVR__)
+  uint8_t oldSREG = SREG;
+  cli();
+  wdt_reset();
+  MCUSR &= ~_BV(WDRF);                 // Clear any previous watchdog reset flag
+  WDTCSR = _BV(WDCE) | _BV(WDE);       // Timed change sequence
+  WDTCSR = _BV(WDIE) | _BV(WDE) | _BV(WDP2);  // Interrupt, then reset; ~250 ms
+  SREG = oldSREG;
+#endif
+}
+
+bool DeadlineMonitor::isFailSafeTripped() {
+  return failSafeTripped;
+}
+
+unsigned long DeadlineMonitor::getTripCount() {
+  noInterrupts();
+  unsigned long count = tripCount;
+  interrupts();
+  return count;
+}
+
+void DeadlineMonitor::resetFailSafe() {
+  noInterrupts();
+  failSafeTripped = false;
+  for (int i = 0; i < taskCount; i++) {
+    tasks[i].consecutiveMisses = 0;
+  }
+  interrupts();
+}
+
+unsigned long DeadlineMonitor::getRuns(int id) {
+  return (id >= 0 && id < taskCount) ? tasks[id].runs : 0;
+}
+
+unsigned long DeadlineMonitor::getOverruns(int id) {
+  return (id >= 0 && id < taskCount) ? tasks[id].overruns : 0;
+}
+
+unsigned long DeadlineMonitor::getWorstUs(int id) {
+  return (id >= 0 && id < taskCount) ? tasks[id].worstUs : 0;
+}
+
+unsigned int DeadlineMonitor::getConsecutiveMisses(int id) {
+  return (id >= 0 && id < taskCount) ? tasks[id].consecutiveMisses : 0;
+}
+
+void DeadlineMonitor::printReport(Print& out) {
+  for (int i = 0; i < taskCount; i++) {
+    out.print(tasks[i].name);
+    out.print(": runs=");
+    out.print(tasks[i].runs);
+    out.print(" overruns=");
+    out.print(tasks[i].overruns);
+    out.print(" worst=");
+    out.print(tasks[i].worstUs);
+    out.print("us budget=");
+    out.print(tasks[i].budgetUs);
+    out.print("us misses=");
+    out.println(tasks[i].consecutiveMisses);
+  }
+  out.print("Fail-safe: ");
+  out.print(failSafeTripped ? "TRIPPED" : "armed");
+  out.print(" (trips=");
+  out.print(getTripCount());
+  out.println(")");
+}
@@ -0,0 +1,112 @@
+/*
+ * DeadlineMonitor.h
+ *
+ * Deadline supervisor for periodic tasks and the main loop.
+ * Each task declares a time budget; the monitor records overruns,
+ * worst-case execution time and consecutive misses in fixed-size counters.
+ *
+ * When a task misses its budget too many times in a row (or is stuck
+ * mid-run long enough to count as that many misses), every registered
+ * Actuator is driven to deactivate(). This is the fail-safe: a stalled
+ * loop must never leave a motor running at its last PWM value.
+ *
+ * Hardware: On AVR boards (Arduino Uno) the watchdog timer runs in
+ * interrupt-and-reset mode, so a stuck task is detected even when loop()
+ * never returns (e.g. a pulseIn() timeout or a full Serial buffer). Each
+ * interrupt re-arms the next one; if the interrupt cannot run (a hang with
+ * interrupts disabled), the following timeout resets the board instead.
+ * After that reset the bootloader (optiboot) starts the sketch with the
+ * watchdog off, and the actuator pins are inputs until setup() runs.
+ */
+
+#ifndef DEADLINEMONITOR_H
+#define DEADLINEMONITOR_H
+
+#include "Actuator.h"
+
+class DeadlineMonitor {
+  public:
+    static const int MAX_TASKS = 4;       // Fixed-size task table (no heap)
+    static const int MAX_ACTUATORS = 4;   // Fixed-size fail-safe list
+
+  private:
+    // Per-task bookkeeping - all counters are fixed size
+    struct TaskStats {
+      const char* name;               // Task name (for reports)
+      unsigned long budgetUs;         // Allowed execution time per run
+      unsigned long runs;             // Completed runs
+      unsigned long overruns;         // Runs that exceeded the budget
+      unsigned long worstUs;          // Worst-case execution time seen
+      unsigned int consecutiveMisses; // Misses in a row (reset on a good run)
+    };
+
+    TaskStats tasks[MAX_TASKS];
+    int taskCount;
+
+    Actuator* actuators[MAX_ACTUATORS];  // Deactivated in registration order
+    int actuatorCount;
+
+    unsigned int missLimit;              // Consecutive misses before fail-safe
+
+    // Shared with the watchdog interrupt
+    volatile int activeTask;             // Task currently running (-1 if none)
+    volatile unsigned long activeStartUs;
+    volatile bool failSafeTripped;
+    volatile unsigned long tripCount;
+
+    void tripFailSafe();
+
+  public:
+    // Constructor: missLimit consecutive misses trigger the fail-safe
+    DeadlineMonitor(unsigned int missLimit = 3);
+
+    // Declare a task with a budget in microseconds
+    // Returns the task id, or -1 if the task table is full
+    int addTask(const char* name, unsigned long budgetUs);
+
+    // Actuators to shut down when the fail-safe trips
+    bool registerActuator(Actuator* actuator);
+    void unregisterActuator(Actuator* actuator);
+
+    // Bracket each run of a task
+    void beginTask(int id);
+    void endTask(int id);
+
+    // Detect a task stuck mid-run; safe to call from an interrupt
+    void watchdogCheck();
+
+    // Start the hardware watchdog in interrupt-and-reset mode (~250 ms period,
+    // AVR only)
+    void armWatchdog();
+
+    // Fail-safe state
+    bool isFailSafeTripped();
+    unsigned long getTripCount();
+    void resetFailSafe();
+
+    // Statistics accessors
+    unsigned long getRuns(int id);
+    unsigned long getOverruns(int id);
+    unsigned long getWorstUs(int id);
+    unsigned int getConsecutiveMisses(int id);
+
+    // Print a one-line summary per task (e.g. to Serial)
+    void printReport(Print& out);
+};
+
+/*
+ * Design Notes:
+ *
+ * - The monitor only knows the abstract Actuator interface, so any
+ *   factory-created actuator (Motor, Servo, Fan) can be protected.
+ * - All storage is fixed at compile time; nothing is allocated at
+ *   runtime, which keeps the watchdog path safe inside an interrupt.
+ * - Once tripped, the fail-safe stays latched until resetFailSafe()
+ *   is called, so the application decides when to resume control.
+ * - The watchdog path calls deactivate() from inside the interrupt.
+ *   Registered actuators must therefore be ISR-safe: no blocking, and
+ *   state plus output updated under ActuatorLock (see Actuator.h), so
+ *   an interrupted setValue() cannot switch the output back on.
+ */
+
+#endif
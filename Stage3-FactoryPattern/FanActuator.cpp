@@ -16,6 +16,7 @@ FanActuator::FanActuator(int fanPin) {
 }
 
 void FanActuator::activate() {
+  ActuatorLock lock;
   isActive = true;
   // Set to last known speed, or medium speed if was 0
   if (currentSpeed == 0) {
@@ -25,6 +26,7 @@ void FanActuator::activate() {
 }
 
 void FanActuator::deactivate() {
+  ActuatorLock lock;  // Also called from the watchdog interrupt
   isActive = false;
   analogWrite(pin, 0);  // Stop fan
 }
@@ -43,6 +45,7 @@ String FanActuator::getType() {
 
 void FanActuator::setSpeed(int speed) {
   // Constrain speed to valid PWM range (0-255)
+  ActuatorLock lock;  // A fail-safe shutdown must not land between check and write
   currentSpeed = constrain(speed, 0, 255);
   
   if (isActive) {
@@ -6,6 +6,7 @@
  */
 
 #include "MotorActuator.h"
+#include "QuadratureEncoder.h"
 
 // Constructor for simple motor (speed control only)
 MotorActuator::MotorActuator(int sPin) {
@@ -13,6 +14,7 @@ MotorActuator::MotorActuator(int sPin) {
   directionPin = -1;  // No direction pin
   currentSpeed = 0;
   isActive = false;
+  encoder = nullptr;  // No speed feedback until attachEncoder()
   pinMode(speedPin, OUTPUT);
   analogWrite(speedPin, 0);  // Start with motor off
 }
@@ -23,6 +25,7 @@ MotorActuator::MotorActuator(int sPin, int dPin) {
   directionPin = dPin;
   currentSpeed = 0;
   isActive = false;
+  encoder = nullptr;
   pinMode(speedPin, OUTPUT);
   pinMode(directionPin, OUTPUT);
   analogWrite(speedPin, 0);
@@ -30,6 +33,7 @@ MotorActuator::MotorActuator(int sPin, int dPin) {
 }
 
 void MotorActuator::activate() {
+  ActuatorLock lock;
   isActive = true;
   // Set to last known speed, or minimum speed if was 0
   if (currentSpeed == 0) {
@@ -39,12 +43,14 @@ void MotorActuator::activate() {
 }
 
 void MotorActuator::deactivate() {
+  ActuatorLock lock;  // Also called from the watchdog interrupt
   isActive = false;
   analogWrite(speedPin, 0);  // Stop motor
 }
 
 void MotorActuator::setValue(int value) {
   // Constrain value to valid PWM range (0-255)
+  ActuatorLock lock;  // A fail-safe shutdown must not land between check and write
   currentSpeed = constrain(value, 0, 255);
   
   if (isActive) {
@@ -65,3 +71,26 @@ void MotorActuator::setDirection(bool forward) {
     digitalWrite(directionPin, forward ? HIGH : LOW);
   }
 }
+
+void MotorActuator::attachEncoder(QuadratureEncoder* enc) {
+  encoder = enc;
+}
+
+bool MotorActuator::hasEncoder() {
+  return encoder != nullptr;
+}
+
+float MotorActuator::updateMeasuredRpm() {
+  // Without an encoder there is no measurement - report 0 rather than guess
+  if (encoder == nullptr) {
+    return 0.0;
+  }
+  return encoder->measureRpm();
+}
+
+float MotorActuator::getMeasuredRpm() {
+  if (encoder == nullptr) {
+    return 0.0;
+  }
+  return encoder->getRpm();
+}
@@ -6,6 +6,7 @@
  * 
  * Hardware: DC motor controlled via PWM pin (and optional direction pin)
  * For Arduino Uno, use any PWM pin (3, 5, 6, 9, 10, 11)
+ * Optional: quadrature encoder for measured speed (see QuadratureEncoder.h)
  */
 
 #ifndef MOTORACTUATOR_H
@@ -13,12 +14,15 @@
 
 #include "Actuator.h"
 
+class QuadratureEncoder;  // See QuadratureEncoder.h
+
 class MotorActuator : public Actuator {
   private:
     int speedPin;      // PWM pin for motor speed control
     int directionPin;  // Optional direction pin (-1 if not used)
     int currentSpeed;  // Current motor speed (0-255)
     bool isActive;     // Whether motor is currently active
+    QuadratureEncoder* encoder;  // Optional speed feedback (nullptr if none)
     
   public:
     // Constructor with speed pin only (simple DC motor)
@@ -36,6 +40,13 @@ class MotorActuator : public Actuator {
     
     // Motor-specific methods
     void setDirection(bool forward);
+    
+    // Speed feedback: getValue() is the commanded PWM,
+    // getMeasuredRpm() is what the encoder actually sees
+    void attachEncoder(QuadratureEncoder* enc);
+    bool hasEncoder();
+    float updateMeasuredRpm();  // Advance the speed estimate; once per control tick
+    float getMeasuredRpm();     // Last estimate (does not advance it)
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,166 @@
+/*
+ * QuadratureEncoder.cpp
+ *
+ * Implementation of the QuadratureEncoder class.
+ * The ISRs are kept as short as possible; all arithmetic that needs
+ * floating point or division happens in measureRpm().
+ */
+
+#include "QuadratureEncoder.h"
+
+QuadratureEncoder* QuadratureEncoder::instance = nullptr;
+
+// Count change indexed by (previous state << 2) | current state.
+// Forward rotation (A leads B) steps 00 -> 10 -> 11 -> 01 -> 00.
+// Entries where both channels changed are 0: the ISR infers those.
+static const int8_t QUAD_TABLE[16] = {
+   0, -1, +1,  0,
+  +1,  0,  0, -1,
+  -1,  0,  0, +1,
+   0, +1, -1,  0
+};
+
+QuadratureEncoder::QuadratureEncoder(int aPin, int bPin, int ppr) {
+  pinA = aPin;
+  pinB = bPin;
+  pulsesPerRev = ppr;
+  countsPerRev = ppr * 4;
+  portA = nullptr;
+  portB = nullptr;
+  maskA = 0;
+  maskB = 0;
+  count = 0;
+  lastEdgeUs = 0;
+  missedEdges = 0;
+  lastState = 0;
+  lastDirection = 0;
+  windowCount = 0;
+  windowEdgeUs = 0;
+  rpm = 0.0;
+  stopped = true;
+}
+
+bool QuadratureEncoder::begin() {
+  int interruptA = digitalPinToInterrupt(pinA);
+  if (interruptA == NOT_AN_INTERRUPT) {
+    return false;
+  }
+
+  pinMode(pinA, INPUT_PULLUP);  // Most encoders have open-collector outputs
+  pinMode(pinB, INPUT_PULLUP);
+  portA = portInputRegister(digitalPinToPort(pinA));
+  portB = portInputRegister(digitalPinToPort(pinB));
+  maskA = digitalPinToBitMask(pinA);
+  maskB = digitalPinToBitMask(pinB);
+
+  noInterrupts();
+  instance = this;
+  lastState = readState();
+  lastDirection = 0;
+  count = 0;
+  interrupts();
+
+  int interruptB = digitalPinToInterrupt(pinB);
+  if (interruptB != NOT_AN_INTERRUPT) {
+    // x4 decoding: every edge of both channels
+    countsPerRev = pulsesPerRev * 4;
+    attachInterrupt(interruptA, isrFullQuad, CHANGE);
+    attachInterrupt(interruptB, isrFullQuad, CHANGE);
+  } else {
+    // x2 decoding: edges of channel A, direction from channel B
+    countsPerRev = pulsesPerRev * 2;
+    attachInterrupt(interruptA, isrChannelA, CHANGE);
+  }
+  return true;
+}
+
+uint8_t QuadratureEncoder::readState() {
+  return ((*portA & maskA) ? 2 : 0) | ((*portB & maskB) ? 1 : 0);
+}
+
+void QuadratureEncoder::isrFullQuad() {
+  QuadratureEncoder* enc = instance;
+  uint8_t state = enc->readState();
+  uint8_t previous = enc->lastState;
+  if (state == previous) return;  // Glitch: no real change
+
+  int8_t step = QUAD_TABLE[(previous << 2) | state];
+  if (step == 0) {
+    // Both channels changed: two edges for one interrupt. The motor
+    // cannot reverse within two edges, so both went the last known way.
+    enc->missedEdges++;
+    step = 2 * enc->lastDirection;
+  } else {
+    enc->lastDirection = step;
+  }
+  enc->count += step;
+  enc->lastState = state;
+  enc->lastEdgeUs = micros();
+}
+
+void QuadratureEncoder::isrChannelA() {
+  QuadratureEncoder* enc = instance;
+  uint8_t state = enc->readState();
+  if (((state ^ enc->lastState) & 2) == 0) return;  // Glitch: A did not change
+
+  // After an A edge, A != B means forward rotation
+  enc->count += ((state == 2) || (state == 1)) ? 1 : -1;
+  enc->lastState = state;
+  enc->lastEdgeUs = micros();
+}
+
+long QuadratureEncoder::getCount() {
+  noInterrupts();  // 32-bit reads are not atomic on AVR
+  long value = count;
+  interrupts();
+  return value;
+}
+
+void QuadratureEncoder::resetCount() {
+  noInterrupts();
+  count = 0;
+  interrupts();
+  windowCount = 0;
+}
+
+float QuadratureEncoder::measureRpm() {
+  noInterrupts();
+  long nowCount = count;
+  unsigned long edgeUs = lastEdgeUs;
+  interrupts();
+
+  long edges = nowCount - windowCount;
+  if (edges != 0) {
+    if (stopped) {
+      // First edges after standstill: start a fresh window, no estimate yet
+      stopped = false;
+    } else {
+      // Period estimation: edges seen divided by the time they spanned
+      unsigned long spanUs = edgeUs - windowEdgeUs;
+      if (spanUs > 0) {
+        rpm = (edges * 60000000.0) / ((float)spanUs * countsPerRev);
+      }
+    }
+    windowCount = nowCount;
+    windowEdgeUs = edgeUs;
+  } else if (micros() - windowEdgeUs > STOP_TIMEOUT_US) {
+    rpm = 0.0;
+    stopped = true;
+  }
+  return rpm;
+}
+
+float QuadratureEncoder::getRpm() {
+  return rpm;
+}
+
+int QuadratureEncoder::getCountsPerRev() {
+  return countsPerRev;
+}
+
+unsigned long QuadratureEncoder::getMissedEdges() {
+  noInterrupts();
+  unsigned long value = missedEdges;
+  interrupts();
+  return value;
+}
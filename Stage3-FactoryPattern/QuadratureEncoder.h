@@ -0,0 +1,111 @@
+/*
+ * QuadratureEncoder.h
+ *
+ * Interrupt-driven quadrature encoder for measuring motor speed.
+ * Gives MotorActuator a measured speed (RPM) to compare with the
+ * commanded PWM value.
+ *
+ * How it works:
+ * - The interrupt service routine (ISR) only decodes the A/B pin state
+ *   and updates a counter and a timestamp (a few microseconds).
+ * - measureRpm() runs in the main loop. It divides the edges counted
+ *   since the last call by the time between the first and last of those
+ *   edges (period estimation), so it stays accurate at both low and
+ *   high speeds.
+ *
+ * Hardware (Arduino Uno):
+ * - Channel A on D2 and channel B on D3 (both external interrupts):
+ *   every edge of both channels is counted (4 counts per pulse, "x4").
+ * - If channel B is not an interrupt pin, only channel A edges are
+ *   counted (2 counts per pulse, "x2").
+ * - Supported edge rate: up to MAX_EDGES_PER_SECOND, i.e. 25000 rpm with
+ *   a 12-pulse encoder at x4. Edges are then 50 us apart, so another
+ *   interrupt may hold the ISR off for up to 50 us before an edge is lost.
+ *   QuickTest.ino (Test 8) measures the ISR cost on the board and checks
+ *   that this rate takes at most a quarter of the CPU.
+ *
+ * Lost edges: the AVR remembers one pending interrupt per pin. If the ISR
+ * is held off while two edges arrive, both channels have changed. The
+ * motor cannot reverse within two edges, so x4 decoding counts them as
+ * two steps in the last known direction (and getMissedEdges() notes the
+ * jump). Three edges look like one step backwards and four like no change
+ * at all; both need the ISR held off for longer than two edge periods,
+ * i.e. an edge rate well above the supported one.
+ *
+ * x2 decoding ignores an interrupt that finds channel A unchanged (a
+ * glitch shorter than the ISR's latency).
+ *
+ * Limitation: the ISR is a static function, so one encoder per sketch.
+ */
+
+#ifndef QUADRATUREENCODER_H
+#define QUADRATUREENCODER_H
+
+#include <Arduino.h>
+
+class QuadratureEncoder {
+  private:
+    int pinA;                 // Channel A (must be an interrupt pin)
+    int pinB;                 // Channel B
+    int pulsesPerRev;         // Encoder pulses per revolution (per channel)
+    int countsPerRev;         // Counted edges per revolution (x4 or x2)
+
+    // Direct port access: digitalRead() is too slow for the ISR
+    volatile uint8_t* portA;
+    volatile uint8_t* portB;
+    uint8_t maskA;
+    uint8_t maskB;
+
+    // Shared with the ISR
+    volatile long count;            // Signed position in counts
+    volatile unsigned long lastEdgeUs;
+    volatile unsigned long missedEdges;  // Both channels changed at once
+    volatile uint8_t lastState;     // Previous (A << 1) | B
+    volatile int8_t lastDirection;  // Last single step: +1, -1 (0 = none yet)
+
+    // Speed estimation (main context only)
+    long windowCount;
+    unsigned long windowEdgeUs;
+    float rpm;
+    bool stopped;
+
+    static QuadratureEncoder* instance;  // Encoder served by the ISR
+    static void isrFullQuad();           // x4: both channels interrupt
+    static void isrChannelA();           // x2: channel A interrupts only
+
+    uint8_t readState();
+
+  public:
+    // No edge for this long means the motor is stopped
+    static const unsigned long STOP_TIMEOUT_US = 250000;
+
+    // Highest edge rate the decoding is specified for (see above)
+    static const unsigned long MAX_EDGES_PER_SECOND = 20000;
+
+    // Constructor: pulses per revolution as printed on the encoder
+    QuadratureEncoder(int aPin, int bPin, int ppr);
+
+    // Configure pins and attach interrupts
+    // Returns false if channel A is not an interrupt-capable pin
+    bool begin();
+
+    // Position in counts (positive = forward)
+    long getCount();
+    void resetCount();
+
+    // Update the speed estimate; call regularly from loop()
+    float measureRpm();
+
+    // Last speed estimate (signed, revolutions per minute)
+    float getRpm();
+
+    // Counts per revolution after decoding (4x or 2x the pulse count)
+    int getCountsPerRev();
+
+    // Jumps where both channels changed between two interrupts, counted
+    // as two steps in the last direction. A diagnostic: a growing number
+    // means the edge rate or the interrupt latency is near its limit.
+    unsigned long getMissedEdges();
+};
+
+#endif
@@ -1,52 +1,223 @@
 /*
  * QuickTest.ino
- * 
+ *
  * Simple test sketch to verify all files compile correctly
  * Tests the Factory Pattern without requiring hardware
  */
 
 #include "ActuatorFactory.h"
+#include "DeadlineMonitor.h"
+#include "QuadratureEncoder.h"
+
+// Test actuator that records when, and in which order, it was shut down
+class ProbeActuator : public Actuator {
+  private:
+    bool active;
+    int value;
+    static volatile int stopCount;  // Shared across probes: gives the order
+
+  public:
+    volatile unsigned long stoppedUs;  // micros() at deactivate()
+    volatile int stopOrder;            // 1 = first probe shut down, 0 = not yet
+
+    ProbeActuator() : active(false), value(0), stoppedUs(0), stopOrder(0) {}
+
+    static void resetOrder() { stopCount = 0; }
+
+    void activate() override {
+      ActuatorLock lock;
+      active = true;
+      stopOrder = 0;
+    }
+    void deactivate() override {
+      ActuatorLock lock;  // Called from the watchdog interrupt in Test 7
+      active = false;
+      stoppedUs = micros();
+      stopOrder = ++stopCount;
+    }
+    void setValue(int v) override { value = v; }
+    int getValue() override { return value; }
+    String getType() override { return "Probe"; }
+    bool isActive() { return active; }
+};
+
+volatile int ProbeActuator::stopCount = 0;
+
+// Global: once armed, the watchdog interrupt keeps a pointer to the monitor
+DeadlineMonitor monitor(3);
+ProbeActuator probeA;
+ProbeActuator probeB;
+QuadratureEncoder encoder(2, 3, 12);  // Driven by the sketch itself in Test 8
+int failures = 0;
+
+void check(bool ok, const char* message) {
+  Serial.print(ok ? "  Success! " : "  FAILED: ");
+  Serial.println(message);
+  if (!ok) failures++;
+}
+
+// Shutdown order and detection latency for a stall that began at startUs
+void checkShutdown(unsigned long startUs, unsigned long minUs, unsigned long maxUs) {
+  check(!probeA.isActive() && !probeB.isActive(), "both actuators deactivated");
+  check(probeA.stopOrder == 1 && probeB.stopOrder == 2, "shut down in registration order");
+
+  unsigned long latencyUs = probeA.stoppedUs - startUs;
+  Serial.print("  Detection latency: ");
+  Serial.print(latencyUs);
+  Serial.println(" us");
+  check(latencyUs >= minUs && latencyUs <= maxUs, "latency within the expected window");
+}
+
+// Write n forward encoder steps to D2/D3 (from both HIGH); returns micros taken
+unsigned long driveEncoderEdges(long n) {
+  unsigned long startUs = micros();
+  for (long i = 0; i < n; i++) {
+    // 11 -> 01 -> 00 -> 10 -> 11: A and B change in turn
+    digitalWrite((i & 1) ? 3 : 2, (i & 2) ? HIGH : LOW);
+  }
+  return micros() - startUs;
+}
 
 void setup() {
   Serial.begin(9600);
   while (!Serial) { ; }
-  
+
   Serial.println("=== Factory Pattern Compilation Test ===\n");
-  
+
   // Test 1: Create each actuator type
   Serial.println("Test 1: Creating Motor...");
   Actuator* motor = ActuatorFactory::createActuator("motor", 5);
+  check(motor != nullptr, "factory created a Motor");
   if (motor != nullptr) {
-    Serial.print("  Success! Type: ");
+    Serial.print("  Type: ");
     Serial.println(motor->getType());
     delete motor;
   }
-  
+
   Serial.println("\nTest 2: Creating Servo...");
   Actuator* servo = ActuatorFactory::createActuator("servo", 9);
+  check(servo != nullptr, "factory created a Servo");
   if (servo != nullptr) {
-    Serial.print("  Success! Type: ");
+    Serial.print("  Type: ");
     Serial.println(servo->getType());
     delete servo;
   }
-  
+
   Serial.println("\nTest 3: Creating Fan...");
   Actuator* fan = ActuatorFactory::createActuator("fan", 6);
+  check(fan != nullptr, "factory created a Fan");
   if (fan != nullptr) {
-    Serial.print("  Success! Type: ");
+    Serial.print("  Type: ");
     Serial.println(fan->getType());
     delete fan;
   }
-  
+
   Serial.println("\nTest 4: Error handling (invalid type)...");
   Actuator* invalid = ActuatorFactory::createActuator("invalid");
-  if (invalid == nullptr) {
-    Serial.println("  Success! Factory returned nullptr for invalid type");
+  check(invalid == nullptr, "factory returned nullptr for invalid type");
+
+  // Deadline monitor tests: two probes, shut down in registration order
+  check(monitor.registerActuator(&probeA) && monitor.registerActuator(&probeB),
+        "probes registered with the deadline monitor");
+
+  Serial.println("\nTest 5: Deadline monitor (repeated overruns)...");
+  int task = monitor.addTask("overrun", 1000);  // 1 ms budget
+  ProbeActuator::resetOrder();
+  probeA.activate();
+  probeB.activate();
+  int stalledRuns = 0;
+  while (!monitor.isFailSafeTripped() && stalledRuns < 10) {
+    monitor.beginTask(task);
+    delay(5);  // Injected overrun: 5x the budget
+    monitor.endTask(task);
+    stalledRuns++;
+  }
+  check(monitor.isFailSafeTripped() && stalledRuns == 3, "fail-safe tripped on the 3rd consecutive miss");
+  check(probeA.stopOrder == 1 && probeB.stopOrder == 2, "shut down in registration order");
+  monitor.resetFailSafe();
+
+  Serial.println("\nTest 6: Deadline monitor (stuck task, watchdogCheck)...");
+  int stuck = monitor.addTask("stuck", 1000);  // Stuck for 3 budgets = 3 ms
+  ProbeActuator::resetOrder();
+  probeA.activate();
+  probeB.activate();
+  unsigned long startUs = micros();
+  monitor.beginTask(stuck);
+  unsigned long begunUs = micros();       // The task's start lies in [startUs, begunUs]
+  unsigned long lastPassedUs = begunUs;   // Start of the last check that did not trip
+  while (!monitor.isFailSafeTripped() && micros() - startUs < 100000UL) {
+    unsigned long checkUs = micros();
+    monitor.watchdogCheck();  // What the watchdog interrupt calls
+    if (!monitor.isFailSafeTripped()) lastPassedUs = checkUs;
+  }
+  // Never before 3 ms, and no check that began after 3 ms let the stall
+  // pass. A fixed upper bound would also time the gaps between checks,
+  // which the host's scheduler can stretch.
+  checkShutdown(startUs, 3000, 100000UL);
+  check(lastPassedUs - begunUs < 3000, "tripped by the first check after 3 ms");
+  monitor.endTask(stuck);
+  monitor.resetFailSafe();
+
+#if defined(__AVR__)
+  Serial.println("\nTest 7: Deadline monitor (stuck task, hardware watchdog)...");
+  int hung = monitor.addTask("hung", 20000);  // Stuck for 3 budgets = 60 ms
+  ProbeActuator::resetOrder();
+  probeA.activate();
+  probeB.activate();
+  monitor.armWatchdog();
+  startUs = micros();
+  monitor.beginTask(hung);
+  while (!monitor.isFailSafeTripped() && micros() - startUs < 2000000UL) {
+    ;  // Simulated hang: only the watchdog interrupt can trip the fail-safe
+  }
+  // Detected on the first watchdog tick after 60 ms: the watchdog period
+  // is 250 ms nominal, +/-10% on its own oscillator
+  checkShutdown(startUs, 60000, 60000 + 280000);
+  monitor.endTask(hung);
+  monitor.resetFailSafe();
+#endif
+
+  Serial.println("\nTest 8: Encoder interrupt cost...");
+  // INT0/INT1 also fire while D2/D3 are outputs, so writing the pins runs
+  // the encoder ISR without an encoder. Each write waits for its ISR,
+  // so the edges come as fast as the ISR can take them.
+  check(encoder.begin(), "encoder attached to D2/D3");
+  pinMode(2, OUTPUT);  // Outputs start HIGH, as the pull-ups left them
+  pinMode(3, OUTPUT);
+  const long EDGES = 2000;
+  unsigned long withIsrUs = driveEncoderEdges(EDGES);
+  check(encoder.getCount() == EDGES && encoder.getMissedEdges() == 0, "every edge counted forward");
+  detachInterrupt(digitalPinToInterrupt(2));
+  detachInterrupt(digitalPinToInterrupt(3));
+  unsigned long withoutIsrUs = driveEncoderEdges(EDGES);  // Same writes, no ISR
+  pinMode(2, INPUT);
+  pinMode(3, INPUT);
+
+  float isrUs = (withIsrUs > withoutIsrUs) ? (float)(withIsrUs - withoutIsrUs) / EDGES : 0.0;
+  Serial.print("  ISR cost: ");
+  Serial.print(isrUs);
+  Serial.print(" us per edge, so at most ");
+  Serial.print(isrUs > 0 ? (unsigned long)(1000000.0 / isrUs) : 0);
+  Serial.println(" edges/s with no time left for the sketch");
+  Serial.print("  At the supported ");
+  Serial.print(QuadratureEncoder::MAX_EDGES_PER_SECOND);
+  Serial.print(" edges/s: ");
+  Serial.print(isrUs * QuadratureEncoder::MAX_EDGES_PER_SECOND / 10000.0);
+  Serial.println("% of the CPU");
+  check(isrUs * QuadratureEncoder::MAX_EDGES_PER_SECOND <= 250000.0,
+        "supported edge rate takes at most 25% of the CPU");
+
+  monitor.printReport(Serial);
+
+  if (failures == 0) {
+    Serial.println("\n=== All Tests Passed! ===");
+    Serial.println("Factory Pattern is working correctly!");
+    Serial.println("\nYou can now upload Stage3.ino for the full demonstration.");
+  } else {
+    Serial.print("\n=== ");
+    Serial.print(failures);
+    Serial.println(" Check(s) FAILED ===");
   }
-  
-  Serial.println("\n=== All Tests Passed! ===");
-  Serial.println("Factory Pattern is working correctly!");
-  Serial.println("\nYou can now upload Stage3.ino for the full demonstration.");
 }
 
 void loop() {
@@ -0,0 +1,58 @@
+/*
+ * RemoteActuator.cpp
+ *
+ * Implementation of the RemoteActuator class.
+ * Every method only updates local state; RemoteLink does the sending.
+ */
+
+#include "RemoteActuator.h"
+#include "RemoteLink.h"
+
+RemoteActuator::RemoteActuator(RemoteLink& remoteLink, uint8_t id) : link(remoteLink) {
+  targetId = id;
+  value = 0;
+  active = false;
+  valueSet = false;
+  valueDirty = false;
+  stateDirty = false;
+  link.attach(this);
+}
+
+RemoteActuator::~RemoteActuator() {
+  link.detach(this);
+}
+
+void RemoteActuator::activate() {
+  ActuatorLock lock;
+  active = true;
+  stateDirty = true;
+}
+
+void RemoteActuator::deactivate() {
+  ActuatorLock lock;  // Also called from the watchdog interrupt
+  active = false;
+  stateDirty = true;
+}
+
+void RemoteActuator::setValue(int newValue) {
+  // Coalesce: only the latest value is sent
+  value = newValue;
+  valueSet = true;
+  valueDirty = true;
+}
+
+int RemoteActuator::getValue() {
+  return value;
+}
+
+String RemoteActuator::getType() {
+  return "Remote";
+}
+
+uint8_t RemoteActuator::getTargetId() {
+  return targetId;
+}
+
+bool RemoteActuator::hasPendingChanges() {
+  return valueDirty || stateDirty;
+}
@@ -0,0 +1,50 @@
+/*
+ * RemoteActuator.h
+ *
+ * Proxy implementation of the Actuator interface for an actuator that
+ * lives on another board. Demonstrates the Proxy pattern: client code
+ * calls activate()/setValue() exactly as it would on a local actuator.
+ *
+ * Calls do not send anything immediately. They only record the desired
+ * state; RemoteLink later sends the latest state of every changed
+ * target in one batched frame. Ten setValue() calls between two link
+ * polls therefore cost one command on the wire, not ten round trips.
+ */
+
+#ifndef REMOTEACTUATOR_H
+#define REMOTEACTUATOR_H
+
+#include "Actuator.h"
+
+class RemoteLink;
+
+class RemoteActuator : public Actuator {
+  friend class RemoteLink;  // The link reads and clears the pending state
+
+  private:
+    RemoteLink& link;    // Serial link to the satellite board
+    uint8_t targetId;    // Actuator id on the satellite board
+    int value;           // Last commanded value
+    bool active;         // Last commanded on/off state
+    bool valueSet;       // setValue() was called at least once
+    bool valueDirty;     // Value changed since it was last sent
+    bool stateDirty;     // On/off state changed since it was last sent
+
+  public:
+    // Constructor: registers the proxy with the link
+    RemoteActuator(RemoteLink& remoteLink, uint8_t id);
+    ~RemoteActuator();
+
+    // Override pure virtual functions from Actuator
+    void activate() override;
+    void deactivate() override;
+    void setValue(int newValue) override;
+    int getValue() override;  // Commanded value (not confirmed by the satellite)
+    String getType() override;
+
+    // Remote-specific methods
+    uint8_t getTargetId();
+    bool hasPendingChanges();
+};
+
+#endif
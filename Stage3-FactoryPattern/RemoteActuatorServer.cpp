@@ -0,0 +1,223 @@
+/*
+ * RemoteActuatorServer.cpp
+ *
+ * Implementation of the RemoteActuatorServer class (satellite side).
+ */
+
+#include "RemoteActuatorServer.h"
+
+using namespace RemoteProtocol;
+
+RemoteActuatorServer::RemoteActuatorServer(Stream& stream, unsigned long timeoutMs) : port(stream) {
+  targetCount = 0;
+  received = 0;
+  expected = 0;
+  inFrame = false;
+  lastSeq = 0;
+  hasLastSeq = false;
+  inSession = false;
+  lastFrameMs = 0;
+  linkTimeoutMs = timeoutMs;
+  framesReceived = 0;
+  commandsApplied = 0;
+  duplicates = 0;
+  badFrames = 0;
+  sessions = 0;
+  linkLosses = 0;
+}
+
+RemoteActuatorServer::~RemoteActuatorServer() {
+  for (int i = 0; i < targetCount; i++) {
+    targets[i].actuator->deactivate();
+    delete targets[i].actuator;
+  }
+}
+
+bool RemoteActuatorServer::addTarget(uint8_t id, const String& type, int pin, int pin2) {
+  if (targetCount >= MAX_TARGETS || getTarget(id) != nullptr) {
+    return false;
+  }
+
+  // FACTORY PATTERN: the server never names a concrete actuator class
+  Actuator* actuator = ActuatorFactory::createActuator(type, pin, pin2);
+  if (actuator == nullptr) {
+    return false;
+  }
+
+  targets[targetCount].id = id;
+  targets[targetCount].actuator = actuator;
+  targetCount++;
+  return true;
+}
+
+Actuator* RemoteActuatorServer::getTarget(uint8_t id) {
+  for (int i = 0; i < targetCount; i++) {
+    if (targets[i].id == id) {
+      return targets[i].actuator;
+    }
+  }
+  return nullptr;
+}
+
+void RemoteActuatorServer::poll() {
+  while (port.available() > 0) {
+    uint8_t b = (uint8_t)port.read();
+
+    if (!inFrame) {
+      if (b == FRAME_START) {
+        inFrame = true;
+        received = 0;
+        expected = 2;  // seq + count, then the rest once count is known
+      }
+      continue;
+    }
+
+    buffer[received++] = b;
+
+    if (received == 2) {
+      uint8_t count = buffer[1];
+      if (count > MAX_COMMANDS) {
+        badFrames++;        // Not a real frame - resynchronize
+        inFrame = false;
+        continue;
+      }
+      expected = 2 + count * COMMAND_SIZE + 1;
+    }
+
+    if (received == expected) {
+      inFrame = false;
+      handleFrame();
+    }
+  }
+
+  // An idle master still sends a heartbeat every HEARTBEAT_MS
+  if (inSession && linkTimeoutMs > 0 && millis() - lastFrameMs >= linkTimeoutMs) {
+    loseLink();
+  }
+}
+
+void RemoteActuatorServer::loseLink() {
+  // Master reset, hung or unplugged: nothing may keep running on the last
+  // command it sent
+  for (int i = 0; i < targetCount; i++) {
+    targets[i].actuator->deactivate();
+  }
+  inSession = false;
+  linkLosses++;
+}
+
+bool RemoteActuatorServer::isConnected() {
+  return inSession;
+}
+
+void RemoteActuatorServer::handleFrame() {
+  uint8_t crc = 0;
+  for (uint8_t i = 0; i < received - 1; i++) {
+    crc = crc8(crc, buffer[i]);
+  }
+  if (crc != buffer[received - 1]) {
+    badFrames++;  // No ack: the master will retransmit
+    return;
+  }
+
+  uint8_t seq = buffer[0];
+  uint8_t count = buffer[1];
+  if (count == 0) {
+    // Session start: the master restarted its sequence numbers. A
+    // retransmitted start just does this again.
+    lastSeq = seq;
+    hasLastSeq = true;
+    inSession = true;
+    lastFrameMs = millis();
+    sessions++;
+    sendAck(seq);
+    return;
+  }
+
+  if (!inSession) {
+    return;  // No ack: the master gives up, starts a session and resends
+  }
+  lastFrameMs = millis();
+
+  if (hasLastSeq && seq == lastSeq) {
+    duplicates++;  // Our ack was lost - ack again, do not apply twice
+    sendAck(seq);
+    return;
+  }
+
+  for (uint8_t c = 0; c < count; c++) {
+    apply(buffer + 2 + c * COMMAND_SIZE);
+  }
+
+  lastSeq = seq;
+  hasLastSeq = true;
+  framesReceived++;
+  sendAck(seq);
+}
+
+void RemoteActuatorServer::apply(const uint8_t* command) {
+  if (command[1] == OP_HEARTBEAT) return;  // Only keeps the session alive
+
+  Actuator* actuator = getTarget(command[0]);
+  if (actuator == nullptr) return;  // Unknown target id
+
+  // POLYMORPHISM: the same dispatch works for Motor, Servo and Fan
+  switch (command[1]) {
+    case OP_SET_VALUE:
+      actuator->setValue((int16_t)(command[2] | (command[3] << 8)));
+      break;
+    case OP_ACTIVATE:
+      actuator->activate();
+      break;
+    case OP_DEACTIVATE:
+      actuator->deactivate();
+      break;
+    default:
+      return;  // Unknown opcode
+  }
+  commandsApplied++;
+}
+
+void RemoteActuatorServer::sendAck(uint8_t seq) {
+  uint8_t ack[3] = {ACK_START, seq, crc8(0, seq)};
+  port.write(ack, 3);
+}
+
+unsigned long RemoteActuatorServer::getFramesReceived() {
+  return framesReceived;
+}
+
+unsigned long RemoteActuatorServer::getCommandsApplied() {
+  return commandsApplied;
+}
+
+unsigned long RemoteActuatorServer::getDuplicates() {
+  return duplicates;
+}
+
+unsigned long RemoteActuatorServer::getBadFrames() {
+  return badFrames;
+}
+
+unsigned long RemoteActuatorServer::getSessions() {
+  return sessions;
+}
+
+unsigned long RemoteActuatorServer::getLinkLosses() {
+  return linkLosses;
+}
+
+void RemoteActuatorServer::printReport(Print& out) {
+  out.print("Server: frames=");
+  out.print(framesReceived);
+  out.print(" commands=");
+  out.print(commandsApplied);
+  out.print(" duplicates=");
+  out.print(duplicates);
+  out.print(" bad=");
+  out.print(badFrames);
+  out.print(" sessions=");
+  out.print(sessions);
+  out.print(" link losses=");
+  out.println(linkLosses);
+}
@@ -0,0 +1,93 @@
+/*
+ * RemoteActuatorServer.h
+ *
+ * Satellite side of the remote actuator protocol (see RemoteProtocol.h).
+ * Owns local actuators created by ActuatorFactory, each with a target id,
+ * and dispatches incoming command frames to them.
+ *
+ * Every valid frame is acknowledged. A retransmitted frame (same sequence
+ * number as the last one) is acknowledged again but not applied twice.
+ * A session start (frame without commands) from a restarted master
+ * clears the duplicate check. Command frames are only applied within a
+ * session.
+ *
+ * Link loss: when no valid frame (commands or heartbeat) arrives for the
+ * link timeout, every target is deactivated and the session ends. Targets
+ * stay off until the master has started a new session and sent them again.
+ */
+
+#ifndef REMOTEACTUATORSERVER_H
+#define REMOTEACTUATORSERVER_H
+
+#include "ActuatorFactory.h"
+#include "RemoteProtocol.h"
+
+class RemoteActuatorServer {
+  public:
+    static const int MAX_TARGETS = 8;
+
+  private:
+    struct Target {
+      uint8_t id;
+      Actuator* actuator;  // Created by ActuatorFactory, owned by the server
+    };
+
+    Stream& port;
+    Target targets[MAX_TARGETS];
+    int targetCount;
+
+    // Frame parser
+    uint8_t buffer[RemoteProtocol::MAX_FRAME_SIZE];
+    uint8_t received;    // Bytes of the current frame (after the start byte)
+    uint8_t expected;    // Total bytes expected after the start byte
+    bool inFrame;
+
+    uint8_t lastSeq;
+    bool hasLastSeq;
+
+    bool inSession;                // Session started and link not lost
+    unsigned long lastFrameMs;     // Last valid frame
+    unsigned long linkTimeoutMs;   // 0 = never time out
+
+    // Statistics
+    unsigned long framesReceived;
+    unsigned long commandsApplied;
+    unsigned long duplicates;
+    unsigned long badFrames;
+    unsigned long sessions;
+    unsigned long linkLosses;
+
+    void handleFrame();
+    void apply(const uint8_t* command);
+    void sendAck(uint8_t seq);
+    void loseLink();
+
+  public:
+    // Constructor: all targets go off after timeoutMs without a valid frame
+    RemoteActuatorServer(Stream& stream, unsigned long timeoutMs = RemoteProtocol::LINK_TIMEOUT_MS);
+    ~RemoteActuatorServer();
+
+    // Create a local actuator through the factory and give it a target id
+    // Returns false if the type is unknown, the id is taken or the table is full
+    bool addTarget(uint8_t id, const String& type, int pin, int pin2 = -1);
+
+    // Local actuator for a target id (nullptr if unknown)
+    Actuator* getTarget(uint8_t id);
+
+    // Read and dispatch incoming frames, check the link; call from loop()
+    void poll();
+
+    // True while a session is running and frames keep arriving
+    bool isConnected();
+
+    // Statistics
+    unsigned long getFramesReceived();
+    unsigned long getCommandsApplied();
+    unsigned long getDuplicates();
+    unsigned long getBadFrames();
+    unsigned long getSessions();
+    unsigned long getLinkLosses();
+    void printReport(Print& out);
+};
+
+#endif
@@ -0,0 +1,268 @@
+/*
+ * RemoteLink.cpp
+ *
+ * Implementation of the RemoteLink class (master side).
+ */
+
+#include "RemoteLink.h"
+#include "RemoteActuator.h"
+
+using namespace RemoteProtocol;
+
+// Ack parser states
+static const uint8_t ACK_WAIT_START = 0;
+static const uint8_t ACK_WAIT_SEQ = 1;
+static const uint8_t ACK_WAIT_CRC = 2;
+
+RemoteLink::RemoteLink(Stream& stream, unsigned long timeoutMs, uint8_t attemptLimit) : port(stream) {
+  targetCount = 0;
+  nextTarget = 0;
+  frameLength = 0;
+  nextSeq = 0;
+  sessionStarted = false;
+  awaitingAck = false;
+  sentMs = 0;
+  attempts = 0;
+  ackTimeoutMs = timeoutMs;
+  maxAttempts = (attemptLimit == 0) ? 1 : attemptLimit;
+  ackState = ACK_WAIT_START;
+  ackSeq = 0;
+  framesSent = 0;
+  commandsSent = 0;
+  retransmits = 0;
+  framesAcked = 0;
+  framesFailed = 0;
+  heartbeats = 0;
+  lastRoundTripMs = 0;
+}
+
+bool RemoteLink::attach(RemoteActuator* target) {
+  if (target == nullptr || targetCount >= MAX_TARGETS) {
+    return false;
+  }
+  targets[targetCount++] = target;
+  return true;
+}
+
+void RemoteLink::detach(RemoteActuator* target) {
+  for (int i = 0; i < targetCount; i++) {
+    if (targets[i] == target) {
+      for (int j = i; j < targetCount - 1; j++) {
+        targets[j] = targets[j + 1];
+      }
+      targetCount--;
+      nextTarget = 0;
+      return;
+    }
+  }
+}
+
+void RemoteLink::poll() {
+  readAcks();
+
+  if (awaitingAck && millis() - sentMs >= ackTimeoutMs) {
+    if (attempts >= maxAttempts) {
+      // Give up on this frame. The satellite may have reset or timed out
+      // the link, so start over with a session and the full state.
+      framesFailed++;
+      awaitingAck = false;
+      restartSession();
+    } else {
+      retransmits++;
+      sendFrame();
+    }
+  }
+
+  if (!awaitingAck && !sessionStarted) {
+    buildSessionStart();  // Changes wait in the proxies until it is acked
+  } else if (awaitingAck) {
+    return;
+  } else if (!buildFrame()) {
+    if (millis() - sentMs < HEARTBEAT_MS) return;
+    buildHeartbeat();     // Nothing to send for a while: show we are alive
+  }
+  attempts = 0;
+  awaitingAck = true;
+  framesSent++;
+  sendFrame();
+}
+
+void RemoteLink::buildSessionStart() {
+  finishFrame(0);
+}
+
+void RemoteLink::buildHeartbeat() {
+  uint8_t* command = frame + 3;
+  command[0] = 0;
+  command[1] = OP_HEARTBEAT;
+  command[2] = 0;
+  command[3] = 0;
+  finishFrame(1);
+  heartbeats++;
+}
+
+bool RemoteLink::buildFrame() {
+  if (targetCount == 0) return false;
+
+  uint8_t count = 0;
+  uint8_t* command = frame + 3;
+
+  // Each target needs at most 2 commands: on/off, then the latest value.
+  // In that order the satellite ends with the value last set, whatever
+  // order activate() and setValue() were called in.
+  for (int n = 0; n < targetCount && count + 2 <= MAX_COMMANDS; n++) {
+    RemoteActuator* target = targets[(nextTarget + n) % targetCount];
+
+    {
+      // The fail-safe may deactivate() from the watchdog interrupt: read
+      // the state and clear its flag together so that change is never lost
+      ActuatorLock lock;
+      if (target->stateDirty) {
+        command[0] = target->targetId;
+        command[1] = target->active ? OP_ACTIVATE : OP_DEACTIVATE;
+        command[2] = 0;
+        command[3] = 0;
+        command += COMMAND_SIZE;
+        count++;
+        target->stateDirty = false;
+      }
+    }
+
+    if (target->valueDirty) {
+      command[0] = target->targetId;
+      command[1] = OP_SET_VALUE;
+      command[2] = (uint8_t)(target->value & 0xFF);
+      command[3] = (uint8_t)((target->value >> 8) & 0xFF);
+      command += COMMAND_SIZE;
+      count++;
+      target->valueDirty = false;
+    }
+  }
+  nextTarget = (nextTarget + 1) % targetCount;
+
+  if (count == 0) return false;
+
+  finishFrame(count);
+  commandsSent += count;
+  return true;
+}
+
+void RemoteLink::finishFrame(uint8_t count) {
+  frame[0] = FRAME_START;
+  frame[1] = nextSeq++;
+  frame[2] = count;
+  frameLength = 3 + count * COMMAND_SIZE;
+
+  uint8_t crc = 0;
+  for (uint8_t i = 1; i < frameLength; i++) {
+    crc = crc8(crc, frame[i]);
+  }
+  frame[frameLength++] = crc;
+}
+
+void RemoteLink::sendFrame() {
+  port.write(frame, frameLength);
+  sentMs = millis();
+  attempts++;
+}
+
+void RemoteLink::readAcks() {
+  while (port.available() > 0) {
+    uint8_t b = (uint8_t)port.read();
+
+    switch (ackState) {
+      case ACK_WAIT_START:
+        if (b == ACK_START) ackState = ACK_WAIT_SEQ;
+        break;
+
+      case ACK_WAIT_SEQ:
+        ackSeq = b;
+        ackState = ACK_WAIT_CRC;
+        break;
+
+      case ACK_WAIT_CRC:
+        ackState = ACK_WAIT_START;
+        if (b == crc8(0, ackSeq) && awaitingAck && ackSeq == frame[1]) {
+          awaitingAck = false;
+          framesAcked++;
+          lastRoundTripMs = millis() - sentMs;
+          if (frame[2] == 0) {
+            sessionStarted = true;
+          }
+        }
+        break;
+    }
+  }
+}
+
+void RemoteLink::restartSession() {
+  // A satellite that lost the session has switched everything off:
+  // send the on/off state of every target again, and every value that
+  // was ever set. The proxies already hold the latest desired state.
+  sessionStarted = false;
+  for (int i = 0; i < targetCount; i++) {
+    ActuatorLock lock;
+    targets[i]->stateDirty = true;
+    if (targets[i]->valueSet) {
+      targets[i]->valueDirty = true;
+    }
+  }
+}
+
+bool RemoteLink::isIdle() {
+  if (awaitingAck) return false;
+  for (int i = 0; i < targetCount; i++) {
+    if (targets[i]->hasPendingChanges()) return false;
+  }
+  return true;
+}
+
+bool RemoteLink::isConnected() {
+  return sessionStarted;
+}
+
+unsigned long RemoteLink::getFramesSent() {
+  return framesSent;
+}
+
+unsigned long RemoteLink::getCommandsSent() {
+  return commandsSent;
+}
+
+unsigned long RemoteLink::getRetransmits() {
+  return retransmits;
+}
+
+unsigned long RemoteLink::getFramesAcked() {
+  return framesAcked;
+}
+
+unsigned long RemoteLink::getFramesFailed() {
+  return framesFailed;
+}
+
+unsigned long RemoteLink::getHeartbeats() {
+  return heartbeats;
+}
+
+unsigned long RemoteLink::getLastRoundTripMs() {
+  return lastRoundTripMs;
+}
+
+void RemoteLink::printReport(Print& out) {
+  out.print("Link: frames=");
+  out.print(framesSent);
+  out.print(" commands=");
+  out.print(commandsSent);
+  out.print(" acked=");
+  out.print(framesAcked);
+  out.print(" retransmits=");
+  out.print(retransmits);
+  out.print(" failed=");
+  out.print(framesFailed);
+  out.print(" heartbeats=");
+  out.print(heartbeats);
+  out.print(" rtt=");
+  out.print(lastRoundTripMs);
+  out.println("ms");
+}
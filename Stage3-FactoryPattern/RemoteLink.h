@@ -0,0 +1,102 @@
+/*
+ * RemoteLink.h
+ *
+ * Master side of the remote actuator protocol (see RemoteProtocol.h).
+ * Collects pending changes from all attached RemoteActuator proxies,
+ * sends them as one sequence-numbered frame, waits for the ack and
+ * retransmits on timeout.
+ *
+ * One frame is in flight at a time. Changes made while waiting for an
+ * ack are coalesced into the next frame, so a busy link sends fewer,
+ * fuller frames instead of falling behind.
+ *
+ * The first frame after a reset is a session start; commands are only
+ * sent once the satellite has acknowledged it. A frame that is never
+ * acked ends the session: the next one replays every target's state.
+ * An idle link sends a heartbeat every RemoteProtocol::HEARTBEAT_MS so
+ * the satellite knows the master is alive.
+ *
+ * Hardware: any Stream - a hardware Serial port (Serial1 on a Mega) or
+ * SoftwareSerial on an Uno. Cross TX/RX and share ground between boards.
+ */
+
+#ifndef REMOTELINK_H
+#define REMOTELINK_H
+
+#include <Arduino.h>
+#include "RemoteProtocol.h"
+
+class RemoteActuator;
+
+class RemoteLink {
+  public:
+    static const int MAX_TARGETS = 8;
+
+  private:
+    Stream& port;
+    RemoteActuator* targets[MAX_TARGETS];
+    int targetCount;
+    int nextTarget;                  // Round-robin start so no target starves
+
+    // Frame in flight
+    uint8_t frame[RemoteProtocol::MAX_FRAME_SIZE];
+    uint8_t frameLength;
+    uint8_t nextSeq;
+    bool sessionStarted;             // Satellite acked the session start
+    bool awaitingAck;
+    unsigned long sentMs;
+    uint8_t attempts;
+
+    unsigned long ackTimeoutMs;
+    uint8_t maxAttempts;
+
+    // Ack parser
+    uint8_t ackState;
+    uint8_t ackSeq;
+
+    // Statistics
+    unsigned long framesSent;
+    unsigned long commandsSent;
+    unsigned long retransmits;
+    unsigned long framesAcked;
+    unsigned long framesFailed;
+    unsigned long heartbeats;
+    unsigned long lastRoundTripMs;
+
+    bool buildFrame();
+    void buildSessionStart();
+    void buildHeartbeat();
+    void finishFrame(uint8_t count);
+    void sendFrame();
+    void readAcks();
+    void restartSession();
+
+  public:
+    // Constructor: ack timeout and attempts before a frame is given up
+    RemoteLink(Stream& stream, unsigned long timeoutMs = 50, uint8_t attemptLimit = 5);
+
+    // Called by RemoteActuator's constructor/destructor
+    bool attach(RemoteActuator* target);
+    void detach(RemoteActuator* target);
+
+    // Process acks, retransmit, and send the next batch; call from loop()
+    void poll();
+
+    // True when nothing is pending and no frame is waiting for an ack
+    bool isIdle();
+
+    // True once the satellite has acknowledged the session start
+    bool isConnected();
+
+    // Statistics
+    unsigned long getFramesSent();
+    unsigned long getCommandsSent();
+    unsigned long getRetransmits();
+    unsigned long getFramesAcked();
+    unsigned long getFramesFailed();
+    unsigned long getHeartbeats();
+    unsigned long getLastRoundTripMs();
+    void printReport(Print& out);
+};
+
+#endif
@@ -0,0 +1,85 @@
+/*
+ * RemoteMaster.ino
+ *
+ * Master board of the remote actuator example: drives a fan and a servo
+ * on a second Uno (running RemoteSatellite.ino) through RemoteActuator
+ * proxies, controlled from the Serial Monitor.
+ *
+ * Hardware Setup:
+ *   - Pin 10 (RX) -> satellite TX (pin 1), pin 11 (TX) -> satellite RX (pin 0)
+ *   - GND -> satellite GND
+ *   - Disconnect the link wires while uploading to the satellite
+ *
+ * Commands (Serial Monitor, 9600 baud):
+ *   a/d - fan on/off        +/- - fan speed up/down
+ *   </> - servo left/right  r   - link report
+ */
+
+#include <SoftwareSerial.h>
+#include "RemoteLink.h"
+#include "RemoteActuator.h"
+
+SoftwareSerial linkPort(10, 11);  // RX, TX
+RemoteLink link(linkPort);
+
+// Target ids as registered in RemoteSatellite.ino
+RemoteActuator remoteFan(link, 1);
+RemoteActuator remoteServo(link, 2);
+
+bool wasConnected = false;
+
+void setup() {
+  Serial.begin(9600);
+  linkPort.begin(9600);
+
+  Serial.println("Remote master: a/d fan on/off, +/- speed, </> servo, r report");
+  Serial.println("Waiting for the satellite...");
+}
+
+void handleCommand(char command) {
+  switch (command) {
+    case 'a':
+      remoteFan.activate();
+      break;
+    case 'd':
+      remoteFan.deactivate();
+      break;
+    case '+':
+      remoteFan.setValue(constrain(remoteFan.getValue() + 25, 0, 255));
+      break;
+    case '-':
+      remoteFan.setValue(constrain(remoteFan.getValue() - 25, 0, 255));
+      break;
+    case '<':
+      remoteServo.setValue(constrain(remoteServo.getValue() - 15, 0, 180));
+      break;
+    case '>':
+      remoteServo.setValue(constrain(remoteServo.getValue() + 15, 0, 180));
+      break;
+    case 'r':
+      link.printReport(Serial);
+      return;
+    default:
+      return;
+  }
+  // Recorded only; the next link.poll() sends it
+  Serial.print("Fan ");
+  Serial.print(remoteFan.getValue());
+  Serial.print(", servo ");
+  Serial.println(remoteServo.getValue());
+}
+
+void loop() {
+  while (Serial.available() > 0) {
+    handleCommand((char)Serial.read());
+  }
+
+  link.poll();  // Session start, acks, retransmits, next batched frame
+
+  // A frame that is never acked ends the session; the link then starts
+  // a new one and sends the fan and servo state again
+  if (link.isConnected() != wasConnected) {
+    wasConnected = link.isConnected();
+    Serial.println(wasConnected ? "Satellite connected" : "Satellite lost, reconnecting...");
+  }
+}
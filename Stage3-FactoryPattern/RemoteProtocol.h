@@ -0,0 +1,65 @@
+/*
+ * RemoteProtocol.h
+ *
+ * Wire format shared by RemoteLink (master board) and
+ * RemoteActuatorServer (satellite board).
+ *
+ * Command frame (master -> satellite):
+ *   [0xA5] [seq] [count] count x [target, opcode, valueLow, valueHigh] [crc8]
+ * Acknowledgement (satellite -> master):
+ *   [0x5A] [seq] [crc8]
+ *
+ * The CRC covers every byte after the start byte. Frames with a bad CRC
+ * are dropped without an ack; the master retransmits them after a timeout.
+ * A repeated sequence number is acknowledged again but not applied twice.
+ *
+ * Session start: a frame with count = 0. After every reset the master
+ * sends one and waits for its ack before the first command frame. The
+ * satellite then forgets the last sequence number, so a restarted
+ * master's frames are never taken for duplicates of the old session.
+ * Outside a session (after a satellite reset or a link loss) command
+ * frames are neither applied nor acked; the master gives them up, starts
+ * a new session and sends every target's state again.
+ *
+ * Within a target, the on/off command comes before the value, so the
+ * value the master last set is what the satellite ends with (activating
+ * a motor or fan at speed 0 would otherwise leave its default speed).
+ *
+ * Heartbeat: a frame with one OP_HEARTBEAT command (target 0), sent by an
+ * idle master every HEARTBEAT_MS. A satellite that receives no valid frame
+ * for LINK_TIMEOUT_MS deactivates every target and ends the session.
+ */
+
+#ifndef REMOTEPROTOCOL_H
+#define REMOTEPROTOCOL_H
+
+#include <Arduino.h>
+
+namespace RemoteProtocol {
+  const uint8_t FRAME_START = 0xA5;
+  const uint8_t ACK_START = 0x5A;
+
+  // Opcodes - one per Actuator method that changes state
+  const uint8_t OP_SET_VALUE = 1;
+  const uint8_t OP_ACTIVATE = 2;
+  const uint8_t OP_DEACTIVATE = 3;
+  const uint8_t OP_HEARTBEAT = 4;   // No action; keeps the session alive
+
+  const unsigned long HEARTBEAT_MS = 100;     // Master: longest silence
+  const unsigned long LINK_TIMEOUT_MS = 500;  // Satellite: then all off
+
+  const uint8_t MAX_COMMANDS = 8;   // Commands per frame
+  const uint8_t COMMAND_SIZE = 4;   // target, opcode, value (2 bytes)
+  const uint8_t MAX_FRAME_SIZE = 3 + MAX_COMMANDS * COMMAND_SIZE + 1;
+
+  // CRC-8 (polynomial 0x07), updated one byte at a time
+  inline uint8_t crc8(uint8_t crc, uint8_t data) {
+    crc ^= data;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+  }
+}
+
+#endif
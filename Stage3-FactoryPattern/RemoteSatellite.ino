@@ -0,0 +1,40 @@
+/*
+ * RemoteSatellite.ino
+ *
+ * Satellite board of the remote actuator example: applies the frames
+ * from RemoteMaster.ino to local actuators created by the factory.
+ * Serial (pins 0/1) is the link, so this sketch prints nothing.
+ *
+ * Hardware Setup:
+ *   - Pin 0 (RX) <- master pin 11, pin 1 (TX) -> master pin 10, shared GND
+ *   - DC Fan on pin 6 (PWM) via transistor/driver
+ *   - Servo on pin 9
+ *   - LED on pin 13 toggles with every frame (the master's heartbeats keep
+ *     it blinking while idle); it stops when the link is lost, and the fan
+ *     and servo are then switched off until the master reconnects
+ */
+
+#include "ActuatorFactory.h"
+#include "RemoteActuatorServer.h"
+
+RemoteActuatorServer server(Serial);
+const int LED_PIN = 13;
+unsigned long lastFrames = 0;
+
+void setup() {
+  pinMode(LED_PIN, OUTPUT);
+  Serial.begin(9600);
+
+  // Target ids as used by RemoteMaster.ino
+  server.addTarget(1, "fan", 6);
+  server.addTarget(2, "servo", 9);
+}
+
+void loop() {
+  server.poll();  // Applies frames, sends acks
+
+  if (server.getFramesReceived() != lastFrames) {
+    lastFrames = server.getFramesReceived();
+    digitalWrite(LED_PIN, (lastFrames & 1) ? HIGH : LOW);
+  }
+}
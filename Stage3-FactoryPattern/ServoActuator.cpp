@@ -14,6 +14,7 @@ ServoActuator::ServoActuator(int servoPin) {
 }
 
 void ServoActuator::activate() {
+  ActuatorLock lock;  // Servo::attach() is not reentrant with detach()
   if (!isActive) {
     servo.attach(pin);
     isActive = true;
@@ -22,6 +23,7 @@ void ServoActuator::activate() {
 }
 
 void ServoActuator::deactivate() {
+  ActuatorLock lock;  // Also called from the watchdog interrupt
   if (isActive) {
     servo.detach();
     isActive = false;
@@ -43,6 +45,7 @@ String ServoActuator::getType() {
 
 void ServoActuator::setAngle(int angle) {
   // Constrain angle to valid servo range (0-180)
+  ActuatorLock lock;
   currentAngle = constrain(angle, 0, 180);
   
   if (isActive) {
@@ -31,29 +31,188 @@
  */
 
 #include "ActuatorFactory.h"
+#include "DeadlineMonitor.h"
+#include "IdleManager.h"
+#include "QuadratureEncoder.h"
+#include "BootSequencer.h"
 
 // Global actuator pointer - demonstrates polymorphism
 // This single pointer can reference any type of actuator
 Actuator* currentActuator = nullptr;
 
+// Every pin an actuator may be wired to (motor, fan, servo - see above)
+const int ACTUATOR_PINS[] = {5, 6, 9};
+
 // Configuration: Change this to test different actuators
 // Options: "motor", "servo", "fan"
 String actuatorType = "servo";  // Default to servo for easy testing
 
+// Deadline supervisor: 3 missed loop deadlines in a row stop all actuators
+DeadlineMonitor monitor(3);
+int loopTask = -1;
+const unsigned long LOOP_BUDGET_US = 50000;  // 50 ms per loop iteration
+bool failSafeReported = false;
+
+// Serial at 9600 baud sends about 1 character per ms once its 64-byte
+// buffer is full. Texts longer than about 100 characters (banner, help,
+// reports) are therefore printed after the timed section of loop().
+const uint8_t TEXT_BANNER = 1;
+const uint8_t TEXT_HELP = 2;
+const uint8_t TEXT_STATUS = 4;
+const uint8_t TEXT_REPORT = 8;
+uint8_t pendingText = 0;
+
+// Sleep between control ticks instead of busy-waiting in delay()
+IdleManager idle;
+int controlTask = -1;
+const unsigned long CONTROL_PERIOD_MS = 100;
+
+// Optional motor speed feedback: encoder A on D2, B on D3 (Uno interrupt pins)
+const int ENCODER_PPR = 12;  // Pulses per revolution of the encoder disc
+QuadratureEncoder encoder(2, 3, ENCODER_PPR);
+MotorActuator* currentMotor = nullptr;  // Set while the current actuator is a motor
+
+// Fast boot: actuators safe first, slow start-up work deferred to loop()
+BootSequencer boot;
+const unsigned long BOOT_BUDGET_US = 2000;  // Time to first control: 2 ms
+int bootTask = -1;  // The critical phase, supervised like the loop
+
+// Demonstration state (runs step by step as a background boot task)
+Actuator* demoActuator = nullptr;
+int demoStep = 0;
+unsigned long demoResumeMs = 0;
+
 void setup() {
-  // Initialize serial for debugging and demonstration
+  // FAST BOOT: nothing here may block. Actuators reach their safe state
+  // in the first milliseconds; the slow parts run later from loop().
+  boot.addCritical("actuators", initActuators);
+  boot.addCritical("supervision", initSupervision);
+  bootTask = monitor.addTask("boot", BOOT_BUDGET_US);
+  monitor.beginTask(bootTask);
+  boot.runCritical();
+  monitor.endTask(bootTask);  // An overrun shows in the 'm' report
+  
+  // Serial.begin() returns immediately; waiting for the port does not
   Serial.begin(9600);
-  while (!Serial) {
-    ; // Wait for serial port to connect
+  boot.addBackground("serial", waitForSerial);
+  boot.addBackground("demo", demonstrateFactoryPatternStep);
+  boot.addBackground("interactive", startInteractiveMode);
+}
+
+void loop() {
+  if (idle.isDue(controlTask)) {
+    monitor.beginTask(loopTask);
+    
+    // Deferred start-up work: serial wait, demo, help text
+    boot.service();
+    
+    // Interactive control via Serial Monitor (after the demo, as before)
+    if (boot.isComplete() && Serial.available() > 0) {
+      char command = Serial.read();
+      handleSerialCommand(command);
+    }
+    
+    // Keep the measured speed estimate fresh
+    if (currentMotor != nullptr) {
+      currentMotor->updateMeasuredRpm();
+    }
+    
+    monitor.endTask(loopTask);
+    
+    // Long texts and the fail-safe notice, outside the timed section
+    printPendingText();
+    if (monitor.isFailSafeTripped() && !failSafeReported) {
+      Serial.println("\n!!! Deadline missed repeatedly - actuators deactivated !!!");
+      Serial.println("Send 'm' for details, 'r' to reset");
+      failSafeReported = true;
+    }
+    Serial.flush();  // The next timed section starts with an empty buffer
+  }
+  
+  // Idle mode, not power-down: PWM, Servo pulses and Serial receive
+  // all need their clocks running between ticks
+  idle.sleepUntilNextTask(true);
+}
+
+/*
+ * CRITICAL BOOT STEPS
+ * Run straight from setup(), before anything that can wait
+ */
+void initActuators() {
+  // Before anything else: after a reset the pins are floating inputs, and
+  // a motor driver or fan transistor may switch on from that. Drive them
+  // LOW first (the output latch, then the direction), whichever actuator
+  // is configured.
+  for (unsigned int i = 0; i < sizeof(ACTUATOR_PINS) / sizeof(ACTUATOR_PINS[0]); i++) {
+    digitalWrite(ACTUATOR_PINS[i], LOW);
+    pinMode(ACTUATOR_PINS[i], OUTPUT);
+  }
+
+  // The constructors drive their own pins to a defined "off" state
+  currentActuator = ActuatorFactory::createActuator(actuatorType);
+  if (actuatorType == "motor" && currentActuator != nullptr) {
+    currentMotor = static_cast<MotorActuator*>(currentActuator);
+    currentMotor->attachEncoder(&encoder);
+  }
+}
+
+void initSupervision() {
+  loopTask = monitor.addTask("loop", LOOP_BUDGET_US);
+  currentActuator = guardActuator(currentActuator);
+  if (currentActuator == nullptr) {
+    currentMotor = nullptr;
+  }
+  monitor.armWatchdog();
+  controlTask = idle.addTask(CONTROL_PERIOD_MS);
+  encoder.begin();
+}
+
+/*
+ * BACKGROUND BOOT STEPS
+ * Each call does a small slice of work and returns true when finished
+ */
+bool waitForSerial() {
+  if (!Serial) {
+    return false;  // Not connected yet - try again next tick
   }
   
+  pendingText |= TEXT_BANNER;
+  return true;
+}
+
+bool startInteractiveMode() {
+  if (currentActuator != nullptr) {
+    Serial.print("Default actuator for interactive mode: ");
+    Serial.println(currentActuator->getType());
+    if (!monitor.isFailSafeTripped()) {
+      currentActuator->activate();
+    }
+  }
+  pendingText |= TEXT_HELP;
+  return true;
+}
+
+/*
+ * LONG TEXTS
+ * Printed from loop() after the timed section (see pendingText)
+ */
+void printPendingText() {
+  if (pendingText & TEXT_BANNER) printBanner();
+  if (pendingText & TEXT_HELP) printHelp();
+  if (pendingText & TEXT_STATUS) printStatus();
+  if (pendingText & TEXT_REPORT) printMonitorReport();
+  pendingText = 0;
+}
+
+void printBanner() {
   Serial.println("========================================");
   Serial.println("Stage 3: Factory Design Pattern");
   Serial.println("========================================\n");
-  
-  // Run comprehensive demonstration
-  demonstrateFactoryPattern();
-  
+  boot.printReport(Serial, BOOT_BUDGET_US);
+  Serial.println();
+}
+
+void printHelp() {
   Serial.println("\n========================================");
   Serial.println("Interactive Mode Starting");
   Serial.println("========================================");
@@ -66,131 +225,241 @@ void setup() {
   Serial.println("  + - Increase value");
   Serial.println("  - - Decrease value");
   Serial.println("  s - Show status");
+  Serial.println("  m - Show deadline monitor, power and boot report");
+  Serial.println("  r - Reset fail-safe");
   Serial.println("========================================\n");
 }
 
-void loop() {
-  // Interactive control via Serial Monitor
-  if (Serial.available() > 0) {
-    char command = Serial.read();
-    handleSerialCommand(command);
+void printStatus() {
+  Serial.println("\n--- Actuator Status ---");
+  if (currentActuator != nullptr) {
+    Serial.print("Type: ");
+    Serial.println(currentActuator->getType());
+    Serial.print("Current Value: ");
+    Serial.println(currentActuator->getValue());
+    if (currentMotor != nullptr && currentMotor->hasEncoder()) {
+      Serial.print("Measured RPM: ");
+      Serial.println(currentMotor->getMeasuredRpm());
+      Serial.print("Encoder count: ");
+      Serial.print(encoder.getCount());
+      Serial.print(" (missed edges: ");
+      Serial.print(encoder.getMissedEdges());
+      Serial.println(")");
+    }
+  } else {
+    Serial.println("No actuator created");
   }
-  
-  delay(100);  // Small delay for stability
+  Serial.println("----------------------");
+}
+
+void printMonitorReport() {
+  Serial.println("\n--- Deadline Monitor ---");
+  monitor.printReport(Serial);
+  idle.printReport(Serial);
+  boot.printReport(Serial, BOOT_BUDGET_US);
+  Serial.println("------------------------");
 }
 
 /*
- * DEMONSTRATION FUNCTION
- * Shows the power of the Factory Pattern with multiple examples
+ * DEMONSTRATION HELPERS
+ * The demo actuator is registered with the deadline monitor, so the
+ * fail-safe covers it too
  */
-void demonstrateFactoryPattern() {
-  Serial.println("--- Demonstration 1: Basic Factory Usage ---\n");
-  
-  // FACTORY PATTERN IN ACTION:
-  // We don't use 'new MotorActuator()' or 'new ServoActuator()'
-  // Instead, we ask the factory to create the appropriate object
-  
-  Serial.println("Creating a Motor actuator using factory...");
-  Actuator* motor = ActuatorFactory::createActuator("motor", 5);
-  
-  if (motor != nullptr) {
-    Serial.print("Created: ");
-    Serial.println(motor->getType());
-    motor->activate();
-    Serial.println("Motor activated");
-    
-    Serial.println("Setting motor speed to 150...");
-    motor->setValue(150);
-    delay(2000);
-    
-    motor->deactivate();
-    Serial.println("Motor deactivated\n");
-    delete motor;  // Clean up
+Actuator* createDemoActuator(const String& type, int pin) {
+  Actuator* actuator = (pin < 0) ? ActuatorFactory::createActuator(type)
+                                 : ActuatorFactory::createActuator(type, pin);
+  return guardActuator(actuator);
+}
+
+// An actuator the fail-safe cannot stop must not run: if the monitor's
+// list is full, it is deleted and nullptr returned, as if creation failed
+Actuator* guardActuator(Actuator* actuator) {
+  if (actuator != nullptr && !monitor.registerActuator(actuator)) {
+    actuator->deactivate();
+    delete actuator;
+    return nullptr;
   }
-  
-  delay(1000);
-  
-  Serial.println("--- Demonstration 2: Polymorphic Behavior ---\n");
-  
-  // Create a servo using the same factory method
-  Serial.println("Creating a Servo actuator using factory...");
-  Actuator* servo = ActuatorFactory::createActuator("servo", 9);
-  
-  if (servo != nullptr) {
-    Serial.print("Created: ");
-    Serial.println(servo->getType());
-    servo->activate();
-    Serial.println("Servo activated");
-    
-    // Same method call (setValue), different behavior!
-    Serial.println("Setting servo to 0 degrees...");
-    servo->setValue(0);
-    delay(1000);
-    
-    Serial.println("Setting servo to 90 degrees...");
-    servo->setValue(90);
-    delay(1000);
-    
-    Serial.println("Setting servo to 180 degrees...");
-    servo->setValue(180);
-    delay(1000);
-    
-    servo->deactivate();
-    Serial.println("Servo deactivated\n");
-    delete servo;
+  return actuator;
+}
+
+void deleteDemoActuator(Actuator* actuator) {
+  if (actuator != nullptr) {
+    actuator->deactivate();
+    monitor.unregisterActuator(actuator);
+    delete actuator;
+  }
+}
+
+// Demo actuators only move while the fail-safe is not latched. The lock
+// keeps a watchdog shutdown from landing between the check and activate().
+bool driveDemoActuator(int value) {
+  ActuatorLock lock;
+  if (demoActuator == nullptr || monitor.isFailSafeTripped()) {
+    return false;
+  }
+  demoActuator->activate();  // No effect if already active
+  demoActuator->setValue(value);
+  return true;
+}
+
+void printDemoBlocked() {
+  Serial.println("Fail-safe latched - stays off");
+}
+
+// Hold the current demo step for a while without blocking the loop
+void holdDemo(unsigned long ms) {
+  demoResumeMs = millis() + ms;
+}
+
+/*
+ * DEMONSTRATION FUNCTION
+ * Shows the power of the Factory Pattern with multiple examples.
+ * Runs as a background boot step: each call performs one step and
+ * schedules the next one instead of calling delay(). Each step prints
+ * at most about 100 characters, so it fits into the loop budget.
+ */
+bool demonstrateFactoryPatternStep() {
+  if ((long)(millis() - demoResumeMs) < 0) {
+    return false;  // Still holding the previous step
   }
   
-  delay(1000);
-  
-  Serial.println("--- Demonstration 3: Easy Substitution ---\n");
-  Serial.println("The factory makes it easy to swap actuator types!");
-  Serial.println("Same code works with different hardware:\n");
-  
-  // Array of different actuator types
-  String types[] = {"motor", "servo", "fan"};
+  // Array of different actuator types (Demonstration 3)
+  static const char* const types[] = {"motor", "servo", "fan"};
   
-  for (int i = 0; i < 3; i++) {
-    Serial.print("Creating: ");
-    Serial.println(types[i]);
-    
-    // Same factory call, different results!
-    Actuator* actuator = ActuatorFactory::createActuator(types[i]);
-    
-    if (actuator != nullptr) {
-      Serial.print("Type: ");
-      Serial.println(actuator->getType());
+  int step = demoStep++;
+  switch (step) {
+    case 0:
+      Serial.println("--- Demonstration 1: Basic Factory Usage ---\n");
+      return false;
+      
+    case 1:
+      // FACTORY PATTERN IN ACTION:
+      // We don't use 'new MotorActuator()' or 'new ServoActuator()'
+      // Instead, we ask the factory to create the appropriate object
+      Serial.println("Creating a Motor actuator using factory...");
+      demoActuator = createDemoActuator("motor", 5);
+      if (demoActuator != nullptr) {
+        Serial.print("Created: ");
+        Serial.println(demoActuator->getType());
+        if (driveDemoActuator(150)) {
+          Serial.println("Motor activated, speed set to 150");
+        } else {
+          printDemoBlocked();
+        }
+        holdDemo(2000);
+      }
+      return false;
+      
+    case 2:
+      deleteDemoActuator(demoActuator);  // Clean up
+      demoActuator = nullptr;
+      Serial.println("Motor deactivated\n");
+      holdDemo(1000);
+      return false;
+      
+    case 3:
+      Serial.println("--- Demonstration 2: Polymorphic Behavior ---\n");
+      return false;
+      
+    case 4:
+      // Create a servo using the same factory method
+      Serial.println("Creating a Servo actuator using factory...");
+      demoActuator = createDemoActuator("servo", 9);
+      if (demoActuator != nullptr) {
+        Serial.print("Created: ");
+        Serial.println(demoActuator->getType());
+        // Same method call (setValue), different behavior!
+        if (driveDemoActuator(0)) {
+          Serial.println("Servo activated, set to 0 degrees");
+        } else {
+          printDemoBlocked();
+        }
+        holdDemo(1000);
+      }
+      return false;
+      
+    case 5:
+    case 6:
+      if (demoActuator != nullptr) {
+        int angle = (step == 5) ? 90 : 180;
+        if (driveDemoActuator(angle)) {
+          Serial.print("Servo set to ");
+          Serial.print(angle);
+          Serial.println(" degrees");
+        } else {
+          printDemoBlocked();
+        }
+        holdDemo(1000);
+      }
+      return false;
+      
+    case 7:
+      deleteDemoActuator(demoActuator);
+      demoActuator = nullptr;
+      Serial.println("Servo deactivated\n");
+      holdDemo(1000);
+      return false;
+      
+    case 8:
+      Serial.println("--- Demonstration 3: Easy Substitution ---\n");
+      return false;
+      
+    case 9:
+      Serial.println("The factory makes it easy to swap actuator types!");
+      Serial.println("Same code works with different hardware:\n");
+      return false;
       
-      actuator->activate();
-      actuator->setValue(100);
-      delay(1000);
-      actuator->deactivate();
+    case 10:
+    case 11:
+    case 12: {
+      int i = step - 10;  // 0, 1, 2
+      if (i > 0) {
+        deleteDemoActuator(demoActuator);  // Finish the previous type
+        demoActuator = nullptr;
+        Serial.println();
+      }
+      
+      Serial.print("Creating: ");
+      Serial.println(types[i]);
       
-      delete actuator;
+      // Same factory call, different results!
+      demoActuator = createDemoActuator(types[i], -1);
+      if (demoActuator != nullptr) {
+        Serial.print("Type: ");
+        Serial.println(demoActuator->getType());
+        if (!driveDemoActuator(100)) {
+          printDemoBlocked();
+        }
+        holdDemo(1000);
+      }
+      return false;
+    }
+      
+    case 13:
+      deleteDemoActuator(demoActuator);
+      demoActuator = nullptr;
       Serial.println();
+      
+      Serial.println("--- Demonstration 4: Error Handling ---\n");
+      return false;
+      
+    case 14: {
+      Serial.println("Attempting to create unknown actuator type...");
+      Actuator* unknown = ActuatorFactory::createActuator("laser");
+      
+      if (unknown == nullptr) {
+        Serial.println("Factory returned nullptr - type not recognized");
+      }
+      return false;
     }
-  }
-  
-  Serial.println("--- Demonstration 4: Error Handling ---\n");
-  
-  Serial.println("Attempting to create unknown actuator type...");
-  Actuator* unknown = ActuatorFactory::createActuator("laser");
-  
-  if (unknown == nullptr) {
-    Serial.println("Factory returned nullptr - type not recognized");
-    Serial.println("This shows proper error handling!\n");
-  }
-  
-  delay(1000);
-  
-  // Create the default actuator for interactive mode
-  Serial.println("Creating default actuator for interactive mode...");
-  currentActuator = ActuatorFactory::createActuator(actuatorType);
-  
-  if (currentActuator != nullptr) {
-    Serial.print("Created: ");
-    Serial.println(currentActuator->getType());
-    currentActuator->activate();
-    Serial.println();
+      
+    case 15:
+      Serial.println("This shows proper error handling!\n");
+      holdDemo(1000);
+      return false;
+      
+    default:
+      return true;  // Demonstration finished
   }
 }
 
@@ -204,11 +473,18 @@ void handleSerialCommand(char command) {
       Serial.println("\n> Creating Motor...");
       if (currentActuator != nullptr) {
         currentActuator->deactivate();
+        monitor.unregisterActuator(currentActuator);
         delete currentActuator;
+        currentMotor = nullptr;
       }
-      currentActuator = ActuatorFactory::createActuator("motor", 5);
+      currentActuator = guardActuator(ActuatorFactory::createActuator("motor", 5));
       if (currentActuator != nullptr) {
+        // We asked the factory for a "motor", so the cast is safe
+        currentMotor = static_cast<MotorActuator*>(currentActuator);
+        currentMotor->attachEncoder(&encoder);
         Serial.println("Motor created and ready");
+      } else {
+        Serial.println("Not created: the fail-safe list is full");
       }
       break;
       
@@ -216,11 +492,15 @@ void handleSerialCommand(char command) {
       Serial.println("\n> Creating Servo...");
       if (currentActuator != nullptr) {
         currentActuator->deactivate();
+        monitor.unregisterActuator(currentActuator);
         delete currentActuator;
+        currentMotor = nullptr;
       }
-      currentActuator = ActuatorFactory::createActuator("servo", 9);
+      currentActuator = guardActuator(ActuatorFactory::createActuator("servo", 9));
       if (currentActuator != nullptr) {
         Serial.println("Servo created and ready");
+      } else {
+        Serial.println("Not created: the fail-safe list is full");
       }
       break;
       
@@ -228,17 +508,23 @@ void handleSerialCommand(char command) {
       Serial.println("\n> Creating Fan...");
       if (currentActuator != nullptr) {
         currentActuator->deactivate();
+        monitor.unregisterActuator(currentActuator);
         delete currentActuator;
+        currentMotor = nullptr;
       }
-      currentActuator = ActuatorFactory::createActuator("fan", 6);
+      currentActuator = guardActuator(ActuatorFactory::createActuator("fan", 6));
       if (currentActuator != nullptr) {
         Serial.println("Fan created and ready");
+      } else {
+        Serial.println("Not created: the fail-safe list is full");
       }
       break;
       
     case 'a':
     case 'A':
-      if (currentActuator != nullptr) {
+      if (monitor.isFailSafeTripped()) {
+        Serial.println("\n> Fail-safe latched - send 'r' to reset first");
+      } else if (currentActuator != nullptr) {
         Serial.println("\n> Activating actuator...");
         currentActuator->activate();
         Serial.println("Activated");
@@ -284,16 +570,19 @@ void handleSerialCommand(char command) {
       
     case 's':
     case 'S':
-      Serial.println("\n--- Actuator Status ---");
-      if (currentActuator != nullptr) {
-        Serial.print("Type: ");
-        Serial.println(currentActuator->getType());
-        Serial.print("Current Value: ");
-        Serial.println(currentActuator->getValue());
-      } else {
-        Serial.println("No actuator created");
-      }
-      Serial.println("----------------------");
+      pendingText |= TEXT_STATUS;
+      break;
+      
+    case 'm':
+    case 'M':
+      pendingText |= TEXT_REPORT;
+      break;
+      
+    case 'r':
+    case 'R':
+      monitor.resetFailSafe();
+      failSafeReported = false;
+      Serial.println("\n> Fail-safe reset (actuator stays off until 'a')");
       break;
   }
 }
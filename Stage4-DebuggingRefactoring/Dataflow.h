@@ -0,0 +1,254 @@
+/*
+ * Dataflow.h
+ *
+ * Statically scheduled sensor-to-actuator dataflow pipeline.
+ *
+ * Instead of hard-coding "read, average, map, write" inside loop(), the
+ * flow is built from small nodes:
+ * - SourceNode   samples a sensor at its own rate
+ * - MapNode      transforms one input (clamping, scaling, ...)
+ * - ZipNode      fuses two inputs (averaging, ...)
+ * - SinkNode     writes the result to an actuator at its own rate
+ *
+ * The graph is assembled at compile time: every node's type names the
+ * nodes it reads from, so node-to-node calls are not virtual, nothing
+ * is allocated and there is no run-time graph. A sink pulls its inputs
+ * depth-first, which visits the nodes in topological order, and the
+ * compiler can inline the chain.
+ *
+ * Nodes only recompute when an input changed, and sinks only write when
+ * their input changed. Each tick carries a sequence number, so a node
+ * shared by several downstream nodes is evaluated once per tick.
+ *
+ * Example:
+ *   SourceNode<1000, Sensor> temp(tempSensor);    // Slow sensor: 1 Hz
+ *   SourceNode<100, Sensor> light(lightSensor);   // Fast sensor: 10 Hz
+ *   auto avg = zipNode<Average>(temp, light);
+ *   auto clamped = mapNode<Clamp<0, 1023> >(avg);
+ *   auto pwm = mapNode<Scale<0, 1023, 0, 255> >(clamped);
+ *   SinkNode<50, decltype(pwm), Actuator> out(pwm, motor);
+ *
+ *   void loop() { out.update(clock.next()); }
+ */
+
+#ifndef DATAFLOW_H
+#define DATAFLOW_H
+
+#include <Arduino.h>
+
+namespace Dataflow {
+
+// One evaluation pass: the current time and a unique sequence number
+struct Tick {
+  unsigned long nowMs;
+  unsigned long seq;
+};
+
+// Produces ticks; call next() once per loop() iteration.
+// With a step, ticks carry logical time (0, step, 2*step, ...) instead of
+// millis(). Use that when a fixed-rate scheduler such as IdleManager
+// drives the pipeline: a wake-up that is 1 ms late must not make a node
+// with the same period skip a whole tick.
+class Clock {
+  private:
+    unsigned long seq;
+    unsigned long stepMs;
+  public:
+    explicit Clock(unsigned long step = 0) : seq(0), stepMs(step) {}
+    Tick next() {
+      Tick tick = {stepMs ? seq * stepMs : millis(), seq + 1};
+      seq++;
+      return tick;
+    }
+};
+
+// --- Transform functions (stateless, fully inlined) ---
+
+template <int Lo, int Hi>
+struct Clamp {
+  static inline int apply(int v) { return constrain(v, Lo, Hi); }
+};
+
+// Linear scaling with the same integer arithmetic as Arduino's map()
+template <long InLo, long InHi, long OutLo, long OutHi>
+struct Scale {
+  static inline int apply(int v) {
+    return (int)((v - InLo) * (OutHi - OutLo) / (InHi - InLo) + OutLo);
+  }
+};
+
+struct Average {
+  static inline int apply(int a, int b) { return (a + b) / 2; }
+};
+
+// --- Nodes ---
+
+// Samples SensorT::readValue() at most once every PeriodMs
+template <unsigned long PeriodMs, typename SensorT>
+class SourceNode {
+  private:
+    SensorT*& sensor;      // Reference to the pointer: may be assigned in setup()
+    int out;
+    bool valid;            // At least one sample taken
+    bool changed;          // Result of the current tick
+    unsigned long lastSampleMs;
+    unsigned long lastSeq;
+
+  public:
+    explicit SourceNode(SensorT*& s)
+      : sensor(s), out(0), valid(false), changed(false), lastSampleMs(0), lastSeq(0) {}
+
+    inline bool update(const Tick& tick) {
+      if (tick.seq == lastSeq) return changed;  // Already evaluated this tick
+      lastSeq = tick.seq;
+      changed = false;
+
+      if (sensor == nullptr) return false;
+      if (valid && tick.nowMs - lastSampleMs < PeriodMs) return false;  // Not due
+
+      lastSampleMs = tick.nowMs;
+      int sample = sensor->readValue();
+      changed = !valid || sample != out;
+      out = sample;
+      valid = true;
+      return changed;
+    }
+
+    inline int value() const { return out; }
+};
+
+// Applies Fn::apply() to one input, only when that input changed
+template <typename Fn, typename In>
+class MapNode {
+  private:
+    In& in;
+    int out;
+    bool valid;
+    bool changed;
+    unsigned long lastSeq;
+
+  public:
+    explicit MapNode(In& input) : in(input), out(0), valid(false), changed(false), lastSeq(0) {}
+
+    inline bool update(const Tick& tick) {
+      if (tick.seq == lastSeq) return changed;
+      lastSeq = tick.seq;
+      changed = false;
+
+      if (in.update(tick) || !valid) {
+        int result = Fn::apply(in.value());
+        changed = !valid || result != out;
+        out = result;
+        valid = true;
+      }
+      return changed;
+    }
+
+    inline int value() const { return out; }
+};
+
+// Applies Fn::apply() to two inputs, only when either input changed
+template <typename Fn, typename InA, typename InB>
+class ZipNode {
+  private:
+    InA& a;
+    InB& b;
+    int out;
+    bool valid;
+    bool changed;
+    unsigned long lastSeq;
+
+  public:
+    ZipNode(InA& inputA, InB& inputB)
+      : a(inputA), b(inputB), out(0), valid(false), changed(false), lastSeq(0) {}
+
+    inline bool update(const Tick& tick) {
+      if (tick.seq == lastSeq) return changed;
+      lastSeq = tick.seq;
+      changed = false;
+
+      // Update both inputs: '||' would skip sampling b when a changed
+      bool changedA = a.update(tick);
+      bool changedB = b.update(tick);
+      if (changedA || changedB || !valid) {
+        int result = Fn::apply(a.value(), b.value());
+        changed = !valid || result != out;
+        out = result;
+        valid = true;
+      }
+      return changed;
+    }
+
+    inline int value() const { return out; }
+};
+
+// Pulls its input at most once every PeriodMs and writes changes to the actuator
+template <unsigned long PeriodMs, typename In, typename ActuatorT>
+class SinkNode {
+  private:
+    In& in;
+    ActuatorT*& actuator;  // Reference to the pointer: may be assigned in setup()
+    bool written;
+    unsigned long lastRunMs;
+    unsigned long writes;
+
+  public:
+    SinkNode(In& input, ActuatorT*& target)
+      : in(input), actuator(target), written(false), lastRunMs(0), writes(0) {}
+
+    // Returns true if a new value was written this tick
+    inline bool update(const Tick& tick) {
+      if (written && tick.nowMs - lastRunMs < PeriodMs) return false;  // Not due
+      lastRunMs = tick.nowMs;
+
+      if (in.update(tick) || !written) {
+        if (actuator != nullptr) {
+          actuator->setValue(in.value());
+          writes++;
+          written = true;
+          return true;
+        }
+      }
+      return false;
+    }
+
+    inline int value() const { return in.value(); }
+    inline unsigned long getWrites() const { return writes; }
+};
+
+// --- Builders: let the compiler deduce node types (use with auto) ---
+
+template <typename Fn, typename In>
+inline MapNode<Fn, In> mapNode(In& input) {
+  return MapNode<Fn, In>(input);
+}
+
+template <typename Fn, typename InA, typename InB>
+inline ZipNode<Fn, InA, InB> zipNode(InA& a, InB& b) {
+  return ZipNode<Fn, InA, InB>(a, b);
+}
+
+}  // namespace Dataflow
+
+/*
+ * Design Notes:
+ *
+ * - Each node stores references to its inputs, so inputs must outlive
+ *   the nodes that read them (declare pipelines as globals, in order).
+ * - Builders return nodes by value; bind each to a named variable
+ *   before passing it on, because nodes keep references to their inputs.
+ * - Cost in Stage4_Refactored.ino (Tools/HostTests/DataflowBench): the
+ *   loop it replaced ran every 800 ms, so 2.5 analogRead() and 1.25
+ *   analogWrite() calls per second (about 0.3 ms of ADC time per second
+ *   on the Uno). The pipeline makes 11 reads per second (about 1.2 ms) and
+ *   writes only on change (at most 1.5 per second measured). In return, the
+ *   motor follows light within 100 ms instead of 800 ms. Temperature, held
+ *   for 1 s, lags a little more than before. The same hand-written
+ *   body run every 50 ms would make 40 reads per second.
+ * - Sources sample and hold: a node reads the last sample of each input,
+ *   so the output lags a change in an input by up to that source's period.
+ * - The node bookkeeping itself costs about as much as the hand-written
+ *   arithmetic (15-25 ns per tick on a PC either way).
+ */
+
+#endif
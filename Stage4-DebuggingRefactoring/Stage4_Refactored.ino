@@ -5,6 +5,10 @@
  */
 
 #include <Arduino.h>
+#include "Dataflow.h"
+#include "IdleManager.h"
+
+using namespace Dataflow;
 
 // --- Sensor hierarchy (fixed) ---
 class Sensor {
@@ -88,17 +92,12 @@ class ActuatorFactory {
     }
 };
 
-// --- Helper: map and clamp combined ---
-int mapToPwm(int raw) {
-  raw = constrain(raw, 0, 1023);
-  return map(raw, 0, 1023, 0, 255);
-}
-
 // --- Application wiring (aligned with README) ---
 const int TEMP_PIN = A0;
 const int LIGHT_PIN = A1;
 const int MOTOR_PWM_PIN = 5;   // PWM
 const int MOTOR_DIR_PIN = 6;   // Optional; safe to leave unconnected if unused
+const unsigned long SERIAL_WAIT_MS = 2000;  // Give up waiting for a host after 2 s
 
 Sensor* sensors[2] = {
   new TemperatureSensor(TEMP_PIN),
@@ -106,39 +105,59 @@ Sensor* sensors[2] = {
 };
 Actuator* motor = nullptr;
 
-void setup() {
-  Serial.begin(9600);
-  while (!Serial) { ; }
-  Serial.println("Stage 4 - Refactored Build\n");
+// --- Dataflow wiring: temp + light -> average -> clamp -> scale to PWM -> motor ---
+// Each sensor is sampled at its own rate; the motor is written only on change
+const unsigned long TEMP_PERIOD_MS = 1000;    // Temperature changes slowly
+const unsigned long LIGHT_PERIOD_MS = 100;
+const unsigned long CONTROL_PERIOD_MS = 50;
+const unsigned long TELEMETRY_PERIOD_MS = 800;
+
+SourceNode<TEMP_PERIOD_MS, Sensor> tempNode(sensors[0]);
+SourceNode<LIGHT_PERIOD_MS, Sensor> lightNode(sensors[1]);
+auto avgNode = zipNode<Average>(tempNode, lightNode);
+auto clampNode = mapNode<Clamp<0, 1023> >(avgNode);
+auto pwmNode = mapNode<Scale<0, 1023, 0, 255> >(clampNode);
+SinkNode<CONTROL_PERIOD_MS, decltype(pwmNode), Actuator> motorSink(pwmNode, motor);
+
+// Sleep between ticks instead of spinning: one control tick every 50 ms
+IdleManager idle;
+int controlTask = -1;
+int telemetryTask = -1;
+Clock pipelineClock(CONTROL_PERIOD_MS);  // One logical tick per control period
 
+void setup() {
+  // Hardware first: after a reset the motor must reach a defined state
+  // (PWM 0) before anything can wait on the Serial port
   for (int i = 0; i < 2; ++i) sensors[i]->begin();
-
   motor = ActuatorFactory::createActuator("motor", MOTOR_PWM_PIN, MOTOR_DIR_PIN);
-  if (motor) {
-    motor->activate();
-  } else {
+  if (motor) motor->activate();
+
+  // Bounded wait: native-USB boards without a host still start the loop
+  Serial.begin(9600);
+  while (!Serial && millis() < SERIAL_WAIT_MS) { ; }
+  Serial.println("Stage 4 - Refactored Build\n");
+  if (!motor) {
     Serial.println("Factory failed: motor not created");
   }
+
+  controlTask = idle.addTask(CONTROL_PERIOD_MS);
+  telemetryTask = idle.addTask(TELEMETRY_PERIOD_MS);
 }
 
 void loop() {
-  // Centralized sensor read
-  int tempRaw = sensors[0]->readValue();
-  int lightRaw = sensors[1]->readValue();
-
-  // Cohesive transformation: compute PWM
-  int avg = (tempRaw + lightRaw) / 2;
-  int pwm = mapToPwm(avg);
-
-  if (motor) {
-    motor->setValue(pwm);
+  // One pass of the pipeline: only due sensors are read, only changes propagate
+  if (idle.isDue(controlTask)) {
+    motorSink.update(pipelineClock.next());
   }
 
-  // Clear telemetry for debugging
-  Serial.print("Temp:"); Serial.print(tempRaw);
-  Serial.print("  Light:"); Serial.print(lightRaw);
-  Serial.print("  PWM:"); Serial.print(pwm);
-  Serial.print("  Stored:"); Serial.println(motor ? motor->getValue() : -1);
+  // Clear telemetry for debugging (same line format as before)
+  if (idle.isDue(telemetryTask)) {
+    Serial.print("Temp:"); Serial.print(tempNode.value());
+    Serial.print("  Light:"); Serial.print(lightNode.value());
+    Serial.print("  PWM:"); Serial.print(pwmNode.value());
+    Serial.print("  Stored:"); Serial.println(motor ? motor->getValue() : -1);
+  }
 
-  delay(800);
+  // The motor PWM needs its timer running, so idle mode (not power-down)
+  idle.sleepUntilNextTask(true);
 }
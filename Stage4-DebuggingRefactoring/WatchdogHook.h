@@ -0,0 +1,31 @@
+/*
+ * WatchdogHook.h
+ *
+ * Owner of the watchdog interrupt vector (WDT_vect). An interrupt vector
+ * can have only one handler, but more than one class uses the watchdog:
+ * IdleManager wakes up from power-down with it, and in Stage 3
+ * DeadlineMonitor checks for stuck tasks. Each registers a handler here, and the one ISR in
+ * WatchdogHook.cpp calls them all in registration order.
+ *
+ * Do not define ISR(WDT_vect) anywhere else. A weak default would not
+ * help either: avr-libc's start-up code already maps every vector to
+ * __bad_interrupt (a restart) weakly, and that one is linked first.
+ */
+
+#ifndef WATCHDOGHOOK_H
+#define WATCHDOGHOOK_H
+
+class WatchdogHook {
+  public:
+    typedef void (*Handler)();
+    static const int MAX_HANDLERS = 2;  // Fixed-size table (no heap)
+
+    // Register a handler, run inside the watchdog interrupt.
+    // Adding the same handler again does nothing; returns false if full.
+    static bool add(Handler handler);
+
+    // Run every handler; called by the ISR
+    static void dispatch();
+};
+
+#endif
@@ -0,0 +1,114 @@
+/*
+ * BootSequencerTest.cpp
+ *
+ * Host test of BootSequencer: critical steps run at once and in order,
+ * background steps run one slice per service() call and in order, and
+ * the time to first control is measured and compared with the budget.
+ * The steps spend simulated time, so the timing checks are exact.
+ */
+
+#include <Arduino.h>
+#include <cstring>
+#include <string>
+#include "BootSequencer.h"
+#include "HostTest.h"
+
+static const unsigned long BUDGET_US = 2000;  // Stage3.ino's BOOT_BUDGET_US
+
+static std::string order;       // Step names in the order they ran
+static unsigned long slowUs = 0;  // Extra time spent by the "pins" step
+static int serialTries = 0;       // Slices until "serial" finishes
+
+static void stepPins() { order += "pins "; HostSim::advanceUs(300 + slowUs); }
+static void stepWatchdog() { order += "watchdog "; HostSim::advanceUs(200); }
+
+static bool stepSerial() {
+  order += "serial ";
+  HostSim::advanceUs(50);
+  return --serialTries <= 0;
+}
+
+static bool stepDemo() { order += "demo "; return true; }
+
+class TextOutput : public Print {
+  public:
+    std::string text;
+    size_t write(uint8_t b) override { text += (char)b; return 1; }
+};
+
+static void setUp(BootSequencer& boot) {
+  HostSim::reset();
+  order.clear();
+  check(boot.addCritical("pins", stepPins), "addCritical");
+  check(boot.addCritical("watchdog", stepWatchdog), "addCritical");
+  check(boot.addBackground("serial", stepSerial), "addBackground");
+  check(boot.addBackground("demo", stepDemo), "addBackground");
+}
+
+static void testOrderAndTiming() {
+  std::printf("Boot within budget\n");
+  BootSequencer boot;
+  setUp(boot);
+  slowUs = 0;
+  serialTries = 3;
+
+  HostSim::advanceUs(100);  // Core start-up before setup()
+  boot.runCritical();
+  check(order == "pins watchdog ", "critical steps run at once, in order");
+  check(boot.getTimeToFirstControlUs() == 600, "time to first control = start-up + steps (600 us)");
+  check(boot.metBudget(BUDGET_US), "within the 2 ms budget");
+
+  order.clear();
+  int ticks = 0;
+  while (!boot.isComplete() && ticks < 10) {
+    check(std::strcmp(boot.getCurrentStepName(), ticks < 3 ? "serial" : "demo") == 0,
+          "current step name");
+    boot.service();
+    HostSim::advanceUs(100000);  // One control tick
+    ticks++;
+  }
+  check(order == "serial serial serial demo ", "one background slice per tick, in order");
+  check(ticks == 4 && boot.isComplete(), "complete after 4 ticks");
+  check(std::strcmp(boot.getCurrentStepName(), "done") == 0, "step name 'done'");
+  boot.service();
+  check(order == "serial serial serial demo ", "service() does nothing once complete");
+
+  TextOutput out;
+  boot.printReport(out, BUDGET_US);
+  std::printf("%s", out.text.c_str());
+  check(out.text.find("budget 2000us, OK") != std::string::npos, "report says OK");
+}
+
+static void testOverBudget() {
+  std::printf("Boot over budget\n");
+  BootSequencer boot;
+  setUp(boot);
+  slowUs = 2000;  // e.g. a blocking call in a critical step
+  serialTries = 1;
+
+  boot.runCritical();
+  check(boot.getTimeToFirstControlUs() == 2500, "slow step measured (2500 us)");
+  check(!boot.metBudget(BUDGET_US), "budget missed");
+
+  TextOutput out;
+  boot.printReport(out, BUDGET_US);
+  std::printf("%s", out.text.c_str());
+  check(out.text.find("OVER") != std::string::npos, "report says OVER");
+}
+
+static void testCapacity() {
+  std::printf("Step table\n");
+  BootSequencer boot;
+  int added = 0;
+  while (boot.addCritical("step", stepPins)) added++;
+  check(added == BootSequencer::MAX_STEPS, "MAX_STEPS critical steps, then false");
+  check(!boot.addBackground("none", nullptr), "null step rejected");
+}
+
+int main() {
+  HostSim::setSerialQuiet(true);
+  testOrderAndTiming();
+  testOverBudget();
+  testCapacity();
+  return finish("BootSequencerTest");
+}
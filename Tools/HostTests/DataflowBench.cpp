@@ -0,0 +1,261 @@
+/*
+ * DataflowBench.cpp
+ *
+ * Stage4_Refactored.ino's Dataflow pipeline (50 ms control ticks,
+ * temperature sampled every 1000 ms, light every 100 ms) against the loop
+ * it replaced: read both sensors, average, clamp, map and write the motor,
+ * then delay(800). The same hand-written body run every 50 ms is shown as
+ * well, to separate the cost of the faster rate from what the pipeline
+ * saves at that rate.
+ *
+ * Reported per second:
+ * - analogRead()/analogWrite() calls. On the Uno an analogRead() takes
+ *   about 112 us (13 ADC clocks at 125 kHz plus overhead), which dwarfs
+ *   everything else in the loop.
+ * - Host time per 50 ms tick, which shows the pipeline's own bookkeeping
+ *   (sequence and period checks) against the hand-written arithmetic.
+ *
+ * With inputs that change between samples the pipeline must follow its
+ * documented sample-and-hold model: the motor gets the last sample of each
+ * source, so it lags a step in an input by up to that source's period.
+ */
+
+#include <Arduino.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "Dataflow.h"
+#include "HostTest.h"
+
+using namespace Dataflow;
+
+// --- Sensor and actuator classes as in Stage4_Refactored.ino ---
+class Sensor {
+  public:
+    virtual int readValue() = 0;
+    virtual ~Sensor() {}
+};
+
+class AnalogSensor : public Sensor {
+  private:
+    int pin;
+  public:
+    explicit AnalogSensor(int p) : pin(p) {}
+    int readValue() override { return analogRead(pin); }
+};
+
+class Actuator {
+  public:
+    virtual void setValue(int value) = 0;
+    virtual int getValue() = 0;
+    virtual ~Actuator() {}
+};
+
+class MotorActuator : public Actuator {
+  private:
+    int speedPin;
+    int currentPwm;
+  public:
+    explicit MotorActuator(int pin) : speedPin(pin), currentPwm(0) {}
+    void setValue(int value) override {
+      currentPwm = constrain(value, 0, 255);
+      analogWrite(speedPin, currentPwm);  // Always active in the sketch
+    }
+    int getValue() override { return currentPwm; }
+};
+
+static const int TEMP_PIN = A0;
+static const int LIGHT_PIN = A1;
+static const int MOTOR_PIN = 5;
+static const int HAND_MOTOR_PIN = 6;  // The hand-written loop's own motor
+
+Sensor* sensors[2] = {new AnalogSensor(TEMP_PIN), new AnalogSensor(LIGHT_PIN)};
+Actuator* motor = new MotorActuator(MOTOR_PIN);
+Actuator* handMotor = new MotorActuator(HAND_MOTOR_PIN);
+
+// --- The pipeline, wired as in Stage4_Refactored.ino ---
+const unsigned long TEMP_PERIOD_MS = 1000;
+const unsigned long LIGHT_PERIOD_MS = 100;
+const unsigned long CONTROL_PERIOD_MS = 50;
+const unsigned long ORIGINAL_PERIOD_MS = 800;  // delay(800) in the loop it replaced
+const long TICKS_PER_SECOND = 1000 / CONTROL_PERIOD_MS;
+
+SourceNode<TEMP_PERIOD_MS, Sensor> tempNode(sensors[0]);
+SourceNode<LIGHT_PERIOD_MS, Sensor> lightNode(sensors[1]);
+auto avgNode = zipNode<Average>(tempNode, lightNode);
+auto clampNode = mapNode<Clamp<0, 1023> >(avgNode);
+auto pwmNode = mapNode<Scale<0, 1023, 0, 255> >(clampNode);
+SinkNode<CONTROL_PERIOD_MS, decltype(pwmNode), Actuator> motorSink(pwmNode, motor);
+Clock pipelineClock(CONTROL_PERIOD_MS);
+long pipelineTicks = 0;  // pipelineClock.next() calls so far
+
+static void pipelineTick() {
+  motorSink.update(pipelineClock.next());
+  pipelineTicks++;
+}
+
+// --- The hand-written loop body it replaced (without telemetry and delay) ---
+static int mapToPwm(int raw) {
+  raw = constrain(raw, 0, 1023);
+  return map(raw, 0, 1023, 0, 255);
+}
+
+static void handWrittenTick() {
+  int tempRaw = sensors[0]->readValue();
+  int lightRaw = sensors[1]->readValue();
+  int avg = (tempRaw + lightRaw) / 2;
+  int pwm = mapToPwm(avg);
+  handMotor->setValue(pwm);
+}
+
+// The original loop: the same body once every 800 ms, i.e. every 16th tick
+static void originalTick(long k) {
+  if (k % (long)(ORIGINAL_PERIOD_MS / CONTROL_PERIOD_MS) == 0) handWrittenTick();
+}
+
+static int tempAt(long k) { return 300 + (k * 3) % 100; }
+static int lightAt(long k) { return 500 + (k * 7) % 300; }
+
+// Sensor inputs for tick k: temperature changes once per second, light
+// every 100 ms (changing) or never (steady)
+static void setInputs(long k, bool changing) {
+  HostSim::setAnalog(TEMP_PIN, changing ? 300 + (k / 20) % 50 : 400);
+  HostSim::setAnalog(LIGHT_PIN, changing ? 500 + (k / 2) % 200 : 600);
+}
+
+struct Cost {
+  double readsPerSecond;
+  double writesPerSecond;
+  double hostNsPerTick;
+};
+
+// Time of the loop with the tick minus the same loop without it
+template <typename TickFn>
+static Cost measure(long ticks, bool changing, TickFn tick) {
+  unsigned long reads = HostSim::getAnalogReads();
+  unsigned long writes = HostSim::getAnalogWrites();
+  auto start = std::chrono::steady_clock::now();
+  for (long k = 0; k < ticks; k++) {
+    setInputs(k, changing);
+    tick(k);
+  }
+  auto withTick = std::chrono::steady_clock::now() - start;
+  Cost cost;
+  cost.readsPerSecond = (double)(HostSim::getAnalogReads() - reads) * TICKS_PER_SECOND / ticks;
+  cost.writesPerSecond = (double)(HostSim::getAnalogWrites() - writes) * TICKS_PER_SECOND / ticks;
+
+  start = std::chrono::steady_clock::now();
+  for (long k = 0; k < ticks; k++) {
+    setInputs(k, changing);
+  }
+  auto inputsOnly = std::chrono::steady_clock::now() - start;
+  cost.hostNsPerTick = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+    withTick - inputsOnly).count() / ticks;
+  return cost;
+}
+
+static void printCost(const char* label, const Cost& cost) {
+  std::printf("  %-17s %5.2f analogRead + %5.2f analogWrite per s (Uno ADC ~%4.0f us/s), host %5.1f ns per tick\n",
+              label, cost.readsPerSecond, cost.writesPerSecond, cost.readsPerSecond * 112,
+              cost.hostNsPerTick);
+}
+
+static void testSampleAndHold() {
+  std::printf("Sample-and-hold with inputs changing on every tick\n");
+  bool followsModel = true;
+  int differsFromFresh = 0;
+  int heldTemp = 0;
+  int heldLight = 0;
+  for (int i = 0; i < 2000; i++) {
+    long k = pipelineTicks;
+    HostSim::setAnalog(TEMP_PIN, tempAt(k));
+    HostSim::setAnalog(LIGHT_PIN, lightAt(k));
+    pipelineTick();
+
+    // What the sources hold: the input at their last sampling tick
+    if (k % (long)(TEMP_PERIOD_MS / CONTROL_PERIOD_MS) == 0) heldTemp = tempAt(k);
+    if (k % (long)(LIGHT_PERIOD_MS / CONTROL_PERIOD_MS) == 0) heldLight = lightAt(k);
+    int pwm = HostSim::getOutput(MOTOR_PIN);
+    if (pwm != mapToPwm((heldTemp + heldLight) / 2)) followsModel = false;
+    if (pwm != mapToPwm((tempAt(k) + lightAt(k)) / 2)) differsFromFresh++;
+  }
+  check(followsModel, "motor PWM from the last temp and light samples on every tick");
+  check(differsFromFresh > 1000, "not the PWM of inputs read on the same tick (reads are held)");
+}
+
+// Worst delay from a step in one input to the motor showing it, over every
+// phase of the step against the sampling periods
+static void testStepLag() {
+  std::printf("Step response (worst case over all sampling phases)\n");
+  unsigned long worstTempMs = 0, worstLightMs = 0, worstOriginalMs = 0;
+  bool settled = true;
+  for (int trial = 0; trial < 2 * 20; trial++) {
+    bool stepTemp = trial < 20;
+    // 41 ticks at the base values and 40 after the step: every trial starts
+    // one tick later in the 20-tick temperature period, the 2-tick light
+    // period and the 16-tick original period
+    for (int i = 0; i < 41; i++) {
+      HostSim::setAnalog(TEMP_PIN, 200);
+      HostSim::setAnalog(LIGHT_PIN, 400);
+      originalTick(pipelineTicks);
+      pipelineTick();
+    }
+    int base = mapToPwm((200 + 400) / 2);
+    if (HostSim::getOutput(MOTOR_PIN) != base || HostSim::getOutput(HAND_MOTOR_PIN) != base) settled = false;
+
+    int temp = stepTemp ? 600 : 200;
+    int light = stepTemp ? 400 : 800;
+    int target = mapToPwm((temp + light) / 2);
+    long pipelineLag = -1, originalLag = -1;
+    for (long t = 0; t < 40; t++) {
+      HostSim::setAnalog(TEMP_PIN, temp);
+      HostSim::setAnalog(LIGHT_PIN, light);
+      originalTick(pipelineTicks);
+      pipelineTick();
+      if (pipelineLag < 0 && HostSim::getOutput(MOTOR_PIN) == target) pipelineLag = t;
+      if (originalLag < 0 && HostSim::getOutput(HAND_MOTOR_PIN) == target) originalLag = t;
+    }
+    if (pipelineLag < 0 || originalLag < 0) {
+      settled = false;
+      continue;
+    }
+    unsigned long& worst = stepTemp ? worstTempMs : worstLightMs;
+    worst = std::max(worst, (unsigned long)pipelineLag * CONTROL_PERIOD_MS);
+    worstOriginalMs = std::max(worstOriginalMs, (unsigned long)originalLag * CONTROL_PERIOD_MS);
+  }
+  std::printf("  dataflow: temp step %lu ms, light step %lu ms; original 800 ms loop: %lu ms\n",
+              worstTempMs, worstLightMs, worstOriginalMs);
+  check(settled, "every step reached the motor");
+  // A step lands between two 50 ms ticks, so it waits up to a period minus a tick
+  check(worstTempMs == TEMP_PERIOD_MS - CONTROL_PERIOD_MS, "temp step shown within 950 ms (1000 ms samples)");
+  check(worstLightMs == LIGHT_PERIOD_MS - CONTROL_PERIOD_MS, "light step shown within 50 ms (100 ms samples)");
+  check(worstOriginalMs == ORIGINAL_PERIOD_MS - CONTROL_PERIOD_MS, "original loop shows any step within 750 ms");
+}
+
+static void bench(const char* label, bool changing) {
+  const long TICKS = 1000000;
+  std::printf("%s inputs (%ld ticks of 50 ms)\n", label, TICKS);
+  Cost flow = measure(TICKS, changing, [](long) { pipelineTick(); });
+  Cost original = measure(TICKS, changing, [](long k) { originalTick(k); });
+  Cost hand = measure(TICKS, changing, [](long) { handWrittenTick(); });
+  printCost("dataflow", flow);
+  printCost("original (800 ms)", original);
+  printCost("hand-written 50 ms", hand);
+  check(std::fabs(flow.readsPerSecond - 11.0) < 0.01 && std::fabs(original.readsPerSecond - 2.5) < 0.01,
+        "11 vs 2.5 analogRead per second (the original loop ran every 800 ms)");
+  check(std::fabs(hand.readsPerSecond - 40.0) < 0.01, "the same body every 50 ms: 40 analogRead per second");
+  check(flow.writesPerSecond <= 1000.0 / LIGHT_PERIOD_MS, "at most one analogWrite per light sample");
+  if (!changing) {
+    check(flow.writesPerSecond < original.writesPerSecond, "steady inputs: fewer analogWrite than the original");
+  }
+}
+
+int main() {
+  HostSim::setSerialQuiet(true);
+  HostSim::reset();
+  testSampleAndHold();
+  testStepLag();
+  bench("Changing", true);
+  bench("Steady", false);
+  return finish("DataflowBench");
+}
@@ -0,0 +1,29 @@
+/*
+ * HostTest.h
+ *
+ * Minimal checks for the host test programs: each check prints one
+ * line, and the program's exit code is the number of failed checks.
+ */
+
+#ifndef HOSTTEST_H
+#define HOSTTEST_H
+
+#include <cstdio>
+
+static int hostTestFailures = 0;
+
+inline void check(bool ok, const char* message) {
+  std::printf("  %s %s\n", ok ? "ok    " : "FAILED", message);
+  if (!ok) hostTestFailures++;
+}
+
+inline int finish(const char* name) {
+  if (hostTestFailures == 0) {
+    std::printf("%s: all checks passed\n", name);
+  } else {
+    std::printf("%s: %d check(s) FAILED\n", name, hostTestFailures);
+  }
+  return hostTestFailures;
+}
+
+#endif
@@ -0,0 +1,218 @@
+/*
+ * IdleManagerSim.cpp
+ *
+ * Host simulation of IdleManager's power-down path. The real
+ * IdleManager.cpp is built with -D__AVR__ against the watchdog and sleep
+ * emulation in stub/AvrSim.cpp, and a Stage 2 style loop (a 300 ms and a
+ * 2000 ms task, power-down between them) runs for 10 simulated minutes.
+ *
+ * Every wake-up is checked against the deadline of the task it was for,
+ * in true (simulated) time. That is independent of millis(), which is
+ * the clock IdleManager itself corrects after each power-down.
+ *
+ * Scenarios: nominal, 10% fast and 10% slow watchdog oscillator, slow
+ * drift with random early wake-ups by other interrupts, and a sudden
+ * 10% step that only the next recalibration can catch. Built against
+ * Stage 3, it runs once more with the DeadlineMonitor watchdog armed:
+ * both then share the watchdog interrupt through WatchdogHook.
+ *
+ * The watchdog ISR is the stage's WatchdogHook.cpp. Without it, AvrSim
+ * restarts the chip on the first watchdog interrupt, as avr-libc does.
+ */
+
+#include <Arduino.h>
+#include "AvrSim.h"
+#include "IdleManager.h"
+#include "HostTest.h"
+
+#if __has_include("DeadlineMonitor.h")
+#include "DeadlineMonitor.h"
+#define HAVE_DEADLINE_MONITOR
+#endif
+
+static const unsigned long long RUN_US = 600ULL * 1000000ULL;  // 10 minutes
+static const unsigned long WORK_US = 500;                      // Awake per tick
+
+struct Scenario {
+  const char* name;
+  double scaleStart;                  // Watchdog period multiplier at the start
+  double scaleEnd;                    // ... at the end (linear drift)
+  bool step;                          // Jump from start to end at half time
+  unsigned long long externalMeanUs;  // Early wake-ups (0 = none)
+  bool idleOnly;                      // Idle mode only, as Stage3.ino sleeps
+};
+
+struct Result {
+  long long worstLateUs;         // Latest wake-up vs. its deadline
+  long long worstEarlyUs;        // Earliest wake-up vs. its deadline
+  long long worstLateSettledUs;  // Latest wake-up from 10 s after a step
+  long long taskWorstLateUs[2];  // Per task
+  unsigned long wakes;
+  double clockErrorPercent;      // millis() vs. true time at the end
+  double microsErrorPercent;     // micros() vs. true time at the end
+  unsigned long reportedLatencyMs;
+  unsigned long earlyWakes;
+  unsigned long powerDowns;
+  unsigned long resets;
+};
+
+#ifdef HAVE_DEADLINE_MONITOR
+// Armed for the run when set: supervises each tick's work
+static DeadlineMonitor* monitor = nullptr;
+static int monitorTask = -1;
+#endif
+
+static double scaleAt(const Scenario& s, unsigned long long nowUs) {
+  double t = (double)nowUs / RUN_US;
+  if (s.step) return t < 0.5 ? s.scaleStart : s.scaleEnd;
+  return s.scaleStart + (s.scaleEnd - s.scaleStart) * t;
+}
+
+static Result run(const Scenario& s) {
+  HostSim::reset();
+  AvrSim::reset();
+  AvrSim::setWatchdogScale(s.scaleStart);
+  if (s.externalMeanUs > 0) {
+    AvrSim::setExternalInterrupts(s.externalMeanUs, 42);
+  }
+
+#ifdef HAVE_DEADLINE_MONITOR
+  if (monitor != nullptr) monitor->armWatchdog();
+#endif
+  IdleManager idle;
+  const int tasks = 2;
+  int ids[tasks] = {idle.addTask(300), idle.addTask(2000)};
+
+  Result r = {};
+  r.worstEarlyUs = 0;
+  for (int i = 0; i < tasks; i++) idle.isDue(ids[i]);  // First run: due at once
+
+  while (HostSim::nowUs() < RUN_US) {
+#ifdef HAVE_DEADLINE_MONITOR
+    if (monitor != nullptr) monitor->beginTask(monitorTask);
+    HostSim::advanceUs(WORK_US);
+    if (monitor != nullptr) monitor->endTask(monitorTask);
+#else
+    HostSim::advanceUs(WORK_US);
+#endif
+
+    // True time at which millis() reaches the earliest due time
+    unsigned long remainingMs = idle.msUntilNextTask();
+    unsigned long long sleepStartUs = HostSim::nowUs();
+    unsigned long long dueUs = sleepStartUs;
+    if (remainingMs > 0) {
+      dueUs += (remainingMs - 1) * 1000ULL + HostSim::usUntilMillisTick();
+    }
+
+    idle.sleepUntilNextTask(s.idleOnly);
+    AvrSim::setWatchdogScale(scaleAt(s, HostSim::nowUs()));
+    r.wakes++;
+
+    long long lateUs = (long long)HostSim::nowUs() - (long long)dueUs;
+    if (lateUs > r.worstLateUs) r.worstLateUs = lateUs;
+    if (lateUs < r.worstEarlyUs) r.worstEarlyUs = lateUs;
+    if (s.step && HostSim::nowUs() > RUN_US / 2 + 10000000ULL && lateUs > r.worstLateSettledUs) {
+      r.worstLateSettledUs = lateUs;
+    }
+
+    // The wake-up was for every task that is now due
+    for (int i = 0; i < tasks; i++) {
+      if (idle.isDue(ids[i]) && lateUs > r.taskWorstLateUs[i]) {
+        r.taskWorstLateUs[i] = lateUs;
+      }
+    }
+  }
+
+  double trueMs = HostSim::nowUs() / 1000.0;
+  r.clockErrorPercent = 100.0 * ((double)millis() - trueMs) / trueMs;
+  r.microsErrorPercent = 100.0 * ((double)micros() / 1000.0 - trueMs) / trueMs;
+  r.reportedLatencyMs = idle.getWorstWakeLatencyMs();
+  r.earlyWakes = idle.getEarlyWakes();
+  r.powerDowns = AvrSim::getPowerDowns();
+  r.resets = AvrSim::getWatchdogResets();
+  return r;
+}
+
+static void print(const Scenario& s, const Result& r) {
+  std::printf("%s\n", s.name);
+  std::printf("  wakes=%lu power-downs=%lu early wakes=%lu (counted by IdleManager)\n",
+              r.wakes, r.powerDowns, r.earlyWakes);
+  std::printf("  wake vs. deadline: latest %+.3f ms, earliest %+.3f ms "
+              "(300 ms task %+.3f ms, 2000 ms task %+.3f ms)\n",
+              r.worstLateUs / 1000.0, r.worstEarlyUs / 1000.0,
+              r.taskWorstLateUs[0] / 1000.0, r.taskWorstLateUs[1] / 1000.0);
+  std::printf("  millis() error after 10 min: %+.4f%%, micros() %+.4f%%, reported worst latency %lu ms\n",
+              r.clockErrorPercent, r.microsErrorPercent, r.reportedLatencyMs);
+}
+
+int main() {
+  HostSim::setSerialQuiet(true);
+  std::printf("IdleManager power-down simulation\n\n");
+
+  // Steady cases: every wake-up within 1.5 ms of its deadline
+  const Scenario steady[] = {
+    {"Nominal watchdog (16 ms)", 1.00, 1.00, false, 0},
+    {"Watchdog 10% fast", 0.90, 0.90, false, 0},
+    {"Watchdog 10% slow, early wakes every ~500 ms", 1.10, 1.10, false, 500000},
+    {"Drift -5% -> +5%, early wakes every ~200 ms", 0.95, 1.05, false, 200000},
+  };
+  for (const Scenario& s : steady) {
+    Result r = run(s);
+    print(s, r);
+    check(r.resets == 0, "no watchdog reset");
+    check(r.worstLateUs <= 1500, "no wake-up more than 1.5 ms after its deadline");
+    check(r.worstEarlyUs >= -1500, "no wake-up more than 1.5 ms before its deadline");
+    check(r.clockErrorPercent > -0.05 && r.clockErrorPercent < 0.05, "millis() within 0.05% of true time");
+    check(r.microsErrorPercent > -0.05 && r.microsErrorPercent < 0.05, "micros() within 0.05% of true time");
+    check(r.reportedLatencyMs * 1000 + 1000 >= (unsigned long)r.worstLateUs,
+          "reported latency covers the true lateness");
+    if (s.externalMeanUs > 0) {
+      // An interrupt just before the watchdog fires ends the same wake-up
+      check(r.earlyWakes > 0 && r.earlyWakes <= AvrSim::getExternalWakes(),
+            "early wake-ups were detected and slept out");
+    }
+    std::printf("\n");
+  }
+
+  // Sudden 10% step: wake-ups are late until the next recalibration,
+  // and the latency statistic must show it
+  Scenario step = {"Watchdog steps from nominal to 10% slow at 5 min", 1.00, 1.10, true, 0};
+  Result r = run(step);
+  print(step, r);
+  std::printf("  latest wake 10 s after the step: %+.3f ms\n", r.worstLateSettledUs / 1000.0);
+  check(r.resets == 0, "no watchdog reset");
+  check(r.worstLateUs > 5000, "the step makes some wake-ups late");
+  check(r.reportedLatencyMs * 1000 + 1000 >= (unsigned long)r.worstLateUs,
+        "reported latency covers the true lateness");
+  check(r.worstLateSettledUs <= 1500, "recalibration brings wake-ups back within 1.5 ms");
+
+#ifdef HAVE_DEADLINE_MONITOR
+  // DeadlineMonitor's watchdog and IdleManager's power-downs take turns
+  // on the one watchdog; neither may starve or reset the other
+  std::printf("\n");
+  DeadlineMonitor deadlines(3);
+  monitorTask = deadlines.addTask("tick", 5000);
+  monitor = &deadlines;
+  Scenario shared = {"Deadline monitor armed, early wakes every ~500 ms", 1.00, 1.00, false, 500000};
+  r = run(shared);
+  print(shared, r);
+  check(r.resets == 0, "no watchdog reset");
+  check(r.worstLateUs <= 1500 && r.worstEarlyUs >= -1500, "every wake-up within 1.5 ms of its deadline");
+  check(r.microsErrorPercent > -0.05 && r.microsErrorPercent < 0.05, "micros() within 0.05% of true time");
+  check(!deadlines.isFailSafeTripped() && deadlines.getOverruns(monitorTask) == 0,
+        "no deadline miss while the work fits its budget");
+
+  // Idle mode leaves the watchdog to DeadlineMonitor: every interrupt must
+  // re-arm the next, or the second timeout resets the board
+  std::printf("\n");
+  Scenario idleOnly = {"Deadline monitor armed, idle mode only", 1.00, 1.00, false, 0, true};
+  r = run(idleOnly);
+  print(idleOnly, r);
+  check(r.resets == 0, "no watchdog reset");
+  check(r.worstLateUs <= 1500 && r.worstEarlyUs >= -1500, "every wake-up within 1.5 ms of its deadline");
+  check(!deadlines.isFailSafeTripped(), "no deadline miss while the work fits its budget");
+  monitor = nullptr;
+#endif
+
+  return finish("IdleManagerSim");
+}
@@ -0,0 +1,273 @@
+/*
+ * QuadratureEncoderTest.cpp
+ *
+ * Host test of QuadratureEncoder and MotorActuator's speed feedback.
+ * A simulated encoder drives pins D2/D3 of the stub, which runs the
+ * encoder ISR on every edge, while the test calls updateMeasuredRpm()
+ * once per 100 ms control tick as Stage3.ino does.
+ *
+ * Lost edges are simulated by holding the pin interrupts: like the AVR,
+ * the stub then remembers one pending interrupt per pin. At the supported
+ * edge rate (QuadratureEncoder::MAX_EDGES_PER_SECOND) the count must stay
+ * exact with the ISR held off for most of an edge period, and for up to
+ * two when the skipped edge is inferred.
+ */
+
+#include <Arduino.h>
+#include <cmath>
+#include "MotorActuator.h"
+#include "QuadratureEncoder.h"
+#include "HostTest.h"
+
+static const int PPR = 12;                   // Pulses per revolution
+static const unsigned long TICK_US = 100000;  // Control tick (CONTROL_PERIOD_MS)
+
+// Forward rotation (A leads B): (A << 1) | B steps 00 -> 10 -> 11 -> 01
+static const int SEQUENCE[4] = {0, 2, 3, 1};
+
+struct SimEncoder {
+  int pinA;
+  int pinB;
+  int phase;  // Index into SEQUENCE; the pull-ups start both pins HIGH (11)
+  long steps;
+
+  SimEncoder(int a, int b) : pinA(a), pinB(b), phase(2), steps(0) {}
+
+  void step(int direction) {
+    phase = (phase + direction + 4) % 4;
+    steps += direction;
+    HostSim::setInput(pinA, SEQUENCE[phase] >> 1);
+    HostSim::setInput(pinB, SEQUENCE[phase] & 1);
+  }
+};
+
+// Turn the encoder at a constant speed; returns the last speed estimate
+static float runAt(MotorActuator& motor, SimEncoder& sim, float rpm, unsigned long durationUs) {
+  double edgeUs = 60000000.0 / (std::fabs(rpm) * PPR * 4);
+  int direction = rpm < 0 ? -1 : 1;
+
+  unsigned long long startUs = HostSim::nowUs();
+  unsigned long long endUs = startUs + durationUs;
+  double nextEdgeUs = startUs + edgeUs;
+  unsigned long long nextTickUs = startUs + TICK_US;
+  float estimate = 0.0;
+
+  while (HostSim::nowUs() < endUs) {
+    unsigned long long edgeAtUs = (unsigned long long)nextEdgeUs;
+    if (edgeAtUs <= nextTickUs) {
+      HostSim::advanceUs(edgeAtUs - HostSim::nowUs());
+      sim.step(direction);
+      nextEdgeUs += edgeUs;
+    } else {
+      HostSim::advanceUs(nextTickUs - HostSim::nowUs());
+      estimate = motor.updateMeasuredRpm();
+      nextTickUs += TICK_US;
+    }
+  }
+  return estimate;
+}
+
+static bool within(float measured, float expected, float percent) {
+  return std::fabs(measured - expected) <= std::fabs(expected) * percent / 100.0;
+}
+
+static void printRpm(const char* label, float expected, float measured) {
+  std::printf("  %s: commanded %.1f rpm, measured %.2f rpm\n", label, expected, measured);
+}
+
+static void testFullQuad() {
+  std::printf("x4 decoding (A on D2, B on D3)\n");
+  HostSim::reset();
+  QuadratureEncoder encoder(2, 3, PPR);
+  MotorActuator motor(5);
+  motor.attachEncoder(&encoder);
+  SimEncoder sim(2, 3);
+
+  check(encoder.begin(), "begin() on interrupt pins");
+  check(encoder.getCountsPerRev() == PPR * 4, "4 counts per pulse");
+
+  // Up to the supported edge rate: 20000 edges/s = 25000 rpm at 12 PPR x4
+  const float maxRpm = QuadratureEncoder::MAX_EDGES_PER_SECOND * 60.0 / (PPR * 4);
+  const float speeds[] = {60.0, 600.0, 6000.0, maxRpm, -600.0, -maxRpm};
+  for (float rpm : speeds) {
+    float measured = runAt(motor, sim, rpm, 1000000);
+    printRpm("steady", rpm, measured);
+    check(within(measured, rpm, 1.0), "speed within 1% (sign = direction)");
+  }
+  check(encoder.getCount() == sim.steps, "count equals the simulated steps");
+  check(encoder.getMissedEdges() == 0, "no missed edges at these speeds");
+
+  // Reading the estimate must not advance it
+  float last = motor.getMeasuredRpm();
+  HostSim::advanceUs(TICK_US);
+  sim.step(-1);
+  check(motor.getMeasuredRpm() == last && encoder.getRpm() == last,
+        "getMeasuredRpm() reads without updating");
+
+  // Standstill: no edge since the last update for longer than the timeout
+  motor.updateMeasuredRpm();
+  HostSim::advanceUs(QuadratureEncoder::STOP_TIMEOUT_US + TICK_US);
+  check(motor.updateMeasuredRpm() == 0.0, "0 rpm after the stop timeout");
+}
+
+static void testLostEdges() {
+  std::printf("Lost edges (interrupts held off)\n");
+  HostSim::reset();
+  QuadratureEncoder encoder(2, 3, PPR);
+  SimEncoder sim(2, 3);
+  encoder.begin();
+
+  // Two edges while held before any direction is known: nothing to infer
+  HostSim::holdInterrupts(true);
+  sim.step(1);
+  sim.step(1);
+  HostSim::holdInterrupts(false);
+  check(encoder.getMissedEdges() == 1 && encoder.getCount() == 0,
+        "2 edges with no direction yet: one missed-edge jump, count unchanged");
+
+  // Two edges after a step forward: both counted forward
+  sim.step(1);
+  HostSim::holdInterrupts(true);
+  sim.step(1);
+  sim.step(1);
+  HostSim::holdInterrupts(false);
+  check(encoder.getMissedEdges() == 2 && encoder.getCount() == 3,
+        "2 edges forward: +2 inferred, jump noted");
+
+  // ... and backwards
+  sim.step(-1);
+  HostSim::holdInterrupts(true);
+  sim.step(-1);
+  sim.step(-1);
+  HostSim::holdInterrupts(false);
+  check(encoder.getMissedEdges() == 3 && encoder.getCount() == 0,
+        "2 edges backwards: -2 inferred, jump noted");
+
+  // Three edges (above the supported rate): look like one step backwards
+  sim.step(1);
+  HostSim::holdInterrupts(true);
+  sim.step(1);
+  sim.step(1);
+  sim.step(1);
+  HostSim::holdInterrupts(false);
+  check(encoder.getMissedEdges() == 3 && encoder.getCount() == 0,
+        "3 edges: decoded as one step backwards, not counted as missed");
+
+  // Four edges: back to the same state, nothing to see
+  HostSim::holdInterrupts(true);
+  for (int i = 0; i < 4; i++) sim.step(1);
+  HostSim::holdInterrupts(false);
+  check(encoder.getMissedEdges() == 3 && encoder.getCount() == 0,
+        "4 edges: lost without a trace");
+}
+
+// Turn the encoder at edgesPerSecond; from every 7th edge on, the ISR is
+// held off for holdUs (another interrupt running). The first hold comes
+// after a few single steps, as a motor cannot reverse at full speed.
+// Returns the double-edge jumps.
+static unsigned long runHeld(SimEncoder& sim, QuadratureEncoder& encoder, int direction,
+                             unsigned long edgesPerSecond, unsigned long holdUs) {
+  const unsigned long edgeUs = 1000000UL / edgesPerSecond;
+  const long edges = 2000;
+  unsigned long missedBefore = encoder.getMissedEdges();
+  bool held = false;
+  unsigned long releaseUs = 0;
+  for (unsigned long t = 0; t < edges * edgeUs; t++) {
+    if (held && t >= releaseUs) {
+      HostSim::holdInterrupts(false);
+      held = false;
+    }
+    if (t % edgeUs == 0) {
+      if (!held && (t / edgeUs) % 7 == 6) {
+        HostSim::holdInterrupts(true);
+        held = true;
+        releaseUs = t + holdUs;
+      }
+      sim.step(direction);
+    }
+    HostSim::advanceUs(1);
+  }
+  HostSim::holdInterrupts(false);
+  return encoder.getMissedEdges() - missedBefore;
+}
+
+static void testMaxEdgeRate() {
+  const unsigned long rate = QuadratureEncoder::MAX_EDGES_PER_SECOND;
+  const unsigned long edgeUs = 1000000UL / rate;
+  std::printf("Interrupt latency at the supported rate (%lu edges/s, %lu us apart)\n", rate, edgeUs);
+  HostSim::reset();
+  QuadratureEncoder encoder(2, 3, PPR);
+  SimEncoder sim(2, 3);
+  encoder.begin();
+
+  unsigned long jumps = runHeld(sim, encoder, 1, rate, edgeUs - 5);
+  check(jumps == 0 && encoder.getCount() == sim.steps, "ISR held off for 45 us: exact, no jumps");
+
+  jumps = runHeld(sim, encoder, 1, rate, edgeUs + edgeUs / 2);
+  std::printf("  held off for %lu us: %lu double-edge jumps\n", edgeUs + edgeUs / 2, jumps);
+  check(jumps > 0 && encoder.getCount() == sim.steps, "held off for 75 us forward: jumps inferred, exact");
+
+  jumps = runHeld(sim, encoder, -1, rate, edgeUs + edgeUs / 2);
+  check(jumps > 0 && encoder.getCount() == sim.steps, "held off for 75 us backwards: jumps inferred, exact");
+}
+
+static void testChannelAGlitch() {
+  std::printf("x2 decoding: glitches on channel A\n");
+  HostSim::reset();
+  QuadratureEncoder encoder(2, 4, PPR);
+  SimEncoder sim(2, 4);
+  encoder.begin();
+
+  sim.step(1);
+  sim.step(1);  // Two steps: one A edge
+  long before = encoder.getCount();
+
+  // A pulse on A shorter than the ISR latency: the ISR finds A unchanged
+  int a = digitalRead(2);
+  HostSim::holdInterrupts(true);
+  HostSim::setInput(2, !a);
+  HostSim::setInput(2, a);
+  HostSim::holdInterrupts(false);
+  check(encoder.getCount() == before, "glitch on A not counted");
+
+  for (int i = 0; i < 8; i++) sim.step(1);
+  check(encoder.getCount() == before + 4, "edges after the glitch counted normally");
+}
+
+static void testChannelAOnly() {
+  std::printf("x2 decoding (A on D2, B on D4)\n");
+  HostSim::reset();
+  QuadratureEncoder encoder(2, 4, PPR);
+  MotorActuator motor(5);
+  motor.attachEncoder(&encoder);
+  SimEncoder sim(2, 4);
+
+  check(encoder.begin(), "begin() with channel B on a plain pin");
+  check(encoder.getCountsPerRev() == PPR * 2, "2 counts per pulse");
+
+  const float speeds[] = {600.0, -600.0};
+  for (float rpm : speeds) {
+    float measured = runAt(motor, sim, rpm, 1000000);
+    printRpm("steady", rpm, measured);
+    check(within(measured, rpm, 1.0), "speed within 1% (sign = direction)");
+  }
+}
+
+static void testNoEncoder() {
+  std::printf("Motor without encoder\n");
+  HostSim::reset();
+  MotorActuator motor(5);
+  check(!motor.hasEncoder(), "hasEncoder() is false");
+  check(motor.updateMeasuredRpm() == 0.0 && motor.getMeasuredRpm() == 0.0, "reports 0 rpm");
+}
+
+int main() {
+  HostSim::setSerialQuiet(true);
+  testFullQuad();
+  testLostEdges();
+  testMaxEdgeRate();
+  testChannelAOnly();
+  testChannelAGlitch();
+  testNoEncoder();
+  return finish("QuadratureEncoderTest");
+}
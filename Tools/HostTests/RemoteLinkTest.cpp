@@ -0,0 +1,348 @@
+/*
+ * RemoteLinkTest.cpp
+ *
+ * Master (RemoteLink + RemoteActuator proxies) and satellite
+ * (RemoteActuatorServer) in one program, connected by a socketpair
+ * (SocketStream.h) and polled in turn on the wall clock.
+ *
+ * Checks:
+ * - Every command reaches the satellite's actuators; repeated changes
+ *   between polls are coalesced; the satellite ends with the value last
+ *   set, whether activate() came before or after setValue().
+ * - A lost frame is retransmitted; a lost ack makes a duplicate that is
+ *   acked again but not applied twice.
+ * - A restarted master (sequence numbers from 0 again) is applied, also
+ *   after a frame cut off by the restart.
+ * - Heartbeats keep an idle link up; a silent master gets every target
+ *   switched off, and reconnecting restores the commanded state.
+ * - With line noise in both directions the satellite ends in the last
+ *   commanded state and no frame is applied twice.
+ *
+ * Benchmarks (commands/s and end-to-end latency, setValue() on the master
+ * until the satellite's actuator has the value) over the bare socket and
+ * at 9600 baud. The socket numbers are the host CPU's cost of the
+ * protocol; the 9600-baud numbers are what the wire allows on the Uno.
+ * They are printed only: the checks there are that every frame was acked
+ * and applied once, which host load cannot change.
+ */
+
+#include <Arduino.h>
+#include <cstdlib>
+#include "RemoteLink.h"
+#include "RemoteActuator.h"
+#include "RemoteActuatorServer.h"
+#include "SocketStream.h"
+#include "HostTest.h"
+
+static const int TARGETS = 4;
+static const char* const TYPES[TARGETS] = {"motor", "fan", "servo", "fan"};
+static const int PINS[TARGETS] = {5, 6, 9, 10};
+
+struct Boards {
+  SocketStream* masterPort;
+  SocketStream* satellitePort;
+  RemoteActuatorServer* server;
+
+  Boards() {
+    HostSim::reset();
+    HostSim::useRealTime(true);
+    if (!SocketStream::pair(masterPort, satellitePort)) {
+      std::printf("socketpair() failed\n");
+      std::exit(1);
+    }
+    server = new RemoteActuatorServer(*satellitePort);
+    for (int i = 0; i < TARGETS; i++) {
+      server->addTarget(i + 1, TYPES[i], PINS[i]);
+    }
+  }
+
+  ~Boards() {
+    delete server;
+    delete masterPort;
+    delete satellitePort;
+  }
+
+  int value(int id) { return server->getTarget(id)->getValue(); }
+};
+
+// Poll both sides until the link has delivered everything (false on timeout)
+static bool runUntilIdle(RemoteLink& link, Boards& boards, unsigned long timeoutMs = 2000) {
+  unsigned long startMs = millis();
+  do {
+    link.poll();
+    boards.server->poll();
+    if (link.isConnected() && link.isIdle()) return true;
+  } while (millis() - startMs < timeoutMs);
+  return false;
+}
+
+static void testLoopback() {
+  std::printf("Loopback\n");
+  Boards boards;
+  RemoteLink link(*boards.masterPort);
+  RemoteActuator motor(link, 1);
+  RemoteActuator fan(link, 2);
+  RemoteActuator servo(link, 3);
+
+  motor.activate();
+  motor.setValue(180);
+  fan.activate();
+  fan.setValue(90);
+  servo.setValue(45);
+  check(runUntilIdle(link, boards), "link idle after delivery");
+  check(boards.server->getSessions() == 1, "one session start");
+  check(boards.value(1) == 180 && HostSim::getOutput(5) == 180, "motor value applied");
+  check(boards.value(2) == 90 && HostSim::getOutput(6) == 90, "fan value applied");
+  check(boards.value(3) == 45, "servo value applied");
+
+  // 100 changes between two polls: only the last one is sent
+  unsigned long commandsBefore = link.getCommandsSent();
+  for (int v = 0; v < 100; v++) fan.setValue(v);
+  check(runUntilIdle(link, boards), "link idle after delivery");
+  check(link.getCommandsSent() - commandsBefore == 1, "100 changes coalesced into 1 command");
+  check(boards.value(2) == 99, "latest value applied");
+
+  motor.deactivate();
+  check(runUntilIdle(link, boards), "link idle after delivery");
+  check(HostSim::getOutput(5) == 0, "motor switched off");
+
+  // The satellite ends with the value last set in either call order
+  // (activating a motor at speed 0 picks its default speed)
+  motor.activate();
+  motor.setValue(0);
+  check(runUntilIdle(link, boards), "link idle after delivery");
+  check(boards.value(1) == 0 && HostSim::getOutput(5) == 0, "activate() then setValue(0): speed 0");
+  motor.deactivate();
+  motor.setValue(0);
+  runUntilIdle(link, boards);
+  motor.setValue(0);
+  motor.activate();
+  check(runUntilIdle(link, boards), "link idle after delivery");
+  check(boards.value(1) == motor.getValue(), "setValue(0) then activate(): as the proxy says");
+
+  check(boards.server->getBadFrames() == 0 && link.getRetransmits() == 0,
+        "no bad frames or retransmits on a clean line");
+}
+
+static void testDroppedFrames() {
+  std::printf("Lost frames and acks\n");
+  Boards boards;
+  RemoteLink link(*boards.masterPort);
+  RemoteActuator fan(link, 2);
+  runUntilIdle(link, boards);  // Session start
+
+  boards.masterPort->dropNext(8);  // The whole 1-command frame
+  fan.setValue(77);
+  check(runUntilIdle(link, boards) && boards.value(2) == 77, "lost frame applied after all");
+  check(link.getRetransmits() == 1, "lost frame retransmitted once");
+
+  boards.satellitePort->dropNext(3);  // The ack
+  fan.setValue(78);
+  unsigned long appliedBefore = boards.server->getCommandsApplied();
+  check(runUntilIdle(link, boards) && boards.value(2) == 78, "frame with a lost ack applied");
+  check(link.getRetransmits() == 2, "frame with a lost ack retransmitted once");
+  check(boards.server->getDuplicates() == 1 && boards.server->getCommandsApplied() - appliedBefore == 1,
+        "retransmission acked again, not applied twice");
+}
+
+static void testMasterRestart() {
+  std::printf("Master restart\n");
+  Boards boards;
+  bool applied = true;
+  for (int boot = 0; boot < 5; boot++) {
+    // Each boot starts from sequence number 0 again, as after a reset
+    RemoteLink link(*boards.masterPort);
+    RemoteActuator fan(link, 2);
+    fan.setValue(100 + boot);
+    if (!runUntilIdle(link, boards) || boards.value(2) != 100 + boot) applied = false;
+  }
+  check(applied, "first command after each of 5 restarts applied");
+  check(boards.server->getDuplicates() == 0, "nothing taken for a duplicate");
+  check(boards.server->getSessions() == 5, "one session start per boot");
+
+  // Restart in the middle of a frame: the start of a 2-command frame,
+  // then nothing more. The next session start is eaten as the rest of
+  // that frame, fails its CRC and is sent again after the ack timeout.
+  const uint8_t partial[] = {RemoteProtocol::FRAME_START, 0, 2, 1, RemoteProtocol::OP_SET_VALUE};
+  boards.masterPort->write(partial, sizeof(partial));
+  RemoteLink link(*boards.masterPort);
+  RemoteActuator fan(link, 2);
+  fan.setValue(42);
+  check(runUntilIdle(link, boards) && boards.value(2) == 42, "applied after a cut-off frame");
+  check(link.getRetransmits() > 0, "session start was retransmitted");
+}
+
+// Poll only the satellite (a hung or unplugged master) for ms
+static void silenceMaster(Boards& boards, unsigned long ms) {
+  unsigned long startMs = millis();
+  while (millis() - startMs < ms) boards.server->poll();
+}
+
+static void testLinkLoss() {
+  std::printf("Link loss\n");
+  Boards boards;
+  RemoteLink link(*boards.masterPort);
+  RemoteActuator fan(link, 2);
+  fan.activate();
+  fan.setValue(120);
+  check(runUntilIdle(link, boards) && HostSim::getOutput(6) == 120, "fan on at 120");
+
+  // Idle for three link timeouts: heartbeats keep the fan running
+  unsigned long startMs = millis();
+  while (millis() - startMs < 3 * RemoteProtocol::LINK_TIMEOUT_MS) {
+    link.poll();
+    boards.server->poll();
+  }
+  check(link.getHeartbeats() >= 10 && boards.server->getLinkLosses() == 0, "heartbeats keep an idle link up");
+  check(HostSim::getOutput(6) == 120, "fan still on");
+
+  silenceMaster(boards, RemoteProtocol::LINK_TIMEOUT_MS + 100);
+  check(boards.server->getLinkLosses() == 1 && !boards.server->isConnected(), "link loss detected");
+  check(HostSim::getOutput(6) == 0 && boards.value(2) == 120, "fan off, value kept");
+
+  // The master's next frame is not acked outside a session: it gives up,
+  // starts a new one and sends the fan's state again
+  check(runUntilIdle(link, boards) && link.isConnected(), "master reconnected");
+  check(boards.server->getSessions() == 2 && link.getFramesFailed() == 1, "through a new session");
+  check(HostSim::getOutput(6) == 120, "fan back on at 120");
+}
+
+static void testNoisyLine() {
+  std::printf("Line noise\n");
+  Boards boards;
+  boards.masterPort->corruptEvery(97);    // One byte in 97: every few frames
+  boards.satellitePort->corruptEvery(29); // One byte in 29: about one ack in 10
+  RemoteLink link(*boards.masterPort, 5, 20);
+  RemoteActuator* proxies[TARGETS];
+  bool on[TARGETS];
+  for (int i = 0; i < TARGETS; i++) {
+    proxies[i] = new RemoteActuator(link, i + 1);
+    on[i] = false;
+  }
+
+  // Random changes of every target, polling in between. Values start at 1:
+  // activating a fan or motor at 0 would pick its default speed.
+  uint32_t rng = 12345;
+  for (int step = 0; step < 2000; step++) {
+    rng = rng * 1103515245 + 12345;
+    int i = (rng >> 16) % TARGETS;
+    proxies[i]->setValue(1 + (rng >> 8) % 179);
+    if ((rng & 0x1F) == 0) {
+      on[i] = !on[i];
+      if (on[i]) proxies[i]->activate(); else proxies[i]->deactivate();
+    }
+    link.poll();
+    boards.server->poll();
+    delayMicroseconds(200);  // Time for frames to go out between changes
+  }
+  check(runUntilIdle(link, boards, 5000), "link idle after the noise");
+
+  bool same = true;
+  for (int i = 0; i < TARGETS; i++) {
+    if (boards.value(i + 1) != proxies[i]->getValue()) same = false;
+    // PWM outputs (motor and fans): the value while on, 0 while off
+    if (PINS[i] != 9 && HostSim::getOutput(PINS[i]) != (on[i] ? proxies[i]->getValue() : 0)) same = false;
+  }
+  check(same, "satellite ends in the last commanded state");
+  std::printf("  frames=%lu retransmits=%lu failed=%lu bad=%lu duplicates=%lu\n",
+              link.getFramesSent(), link.getRetransmits(), link.getFramesFailed(),
+              boards.server->getBadFrames(), boards.server->getDuplicates());
+  check(boards.server->getBadFrames() > 0, "corrupted frames were rejected");
+  check(boards.server->getDuplicates() > 0, "frames with lost acks were not applied twice");
+
+  for (int i = 0; i < TARGETS; i++) delete proxies[i];
+}
+
+// A 1 s ack timeout: on a loaded host a late ack must not turn into a
+// retransmission here
+static const unsigned long BENCH_ACK_TIMEOUT_MS = 1000;
+
+// Every frame acked, and none taken for a duplicate
+static void checkClean(RemoteLink& link, Boards& boards) {
+  check(link.getFramesAcked() == link.getFramesSent(), "every frame acked");
+  check(boards.server->getDuplicates() == 0 && link.getRetransmits() == 0, "no retransmits or duplicates");
+}
+
+// Commands/s with every target changing on every poll, for durationMs
+static void benchThroughput(const char* label, unsigned long baud, unsigned long durationMs) {
+  Boards boards;
+  boards.masterPort->setBaud(baud);
+  boards.satellitePort->setBaud(baud);
+  RemoteLink link(*boards.masterPort, BENCH_ACK_TIMEOUT_MS);
+  RemoteActuator* proxies[TARGETS];
+  for (int i = 0; i < TARGETS; i++) proxies[i] = new RemoteActuator(link, i + 1);
+  runUntilIdle(link, boards);  // Session start
+
+  unsigned long startUs = micros();
+  unsigned long appliedBefore = boards.server->getCommandsApplied();
+  int v = 0;
+  while (micros() - startUs < durationMs * 1000UL) {
+    for (int i = 0; i < TARGETS; i++) proxies[i]->setValue(v % 180);
+    v++;
+    link.poll();
+    boards.server->poll();
+  }
+  runUntilIdle(link, boards);
+  float seconds = (micros() - startUs) / 1e6;
+  unsigned long applied = boards.server->getCommandsApplied() - appliedBefore;
+  float perSecond = applied / seconds;
+  std::printf("  %s: %.0f commands/s, %.0f frames/s (%.1f commands per frame)\n", label,
+              perSecond, link.getFramesSent() / seconds,
+              (float)link.getCommandsSent() / link.getFramesSent());
+  check(boards.value(1) == (v - 1) % 180, "last value applied");
+  checkClean(link, boards);
+
+  for (int i = 0; i < TARGETS; i++) delete proxies[i];
+}
+
+// setValue() on the master until the satellite's actuator has the value
+static void benchLatency(const char* label, unsigned long baud, int samples) {
+  Boards boards;
+  boards.masterPort->setBaud(baud);
+  boards.satellitePort->setBaud(baud);
+  RemoteLink link(*boards.masterPort, BENCH_ACK_TIMEOUT_MS);
+  RemoteActuator fan(link, 2);
+  runUntilIdle(link, boards);  // Session start
+
+  unsigned long totalUs = 0;
+  unsigned long worstUs = 0;
+  bool allApplied = true;
+  for (int i = 0; i < samples; i++) {
+    int value = (i % 2 == 0) ? 200 : 100;
+    unsigned long startUs = micros();
+    fan.setValue(value);
+    while (boards.value(2) != value && micros() - startUs < 1000000UL) {
+      link.poll();
+      boards.server->poll();
+    }
+    unsigned long us = micros() - startUs;
+    if (boards.value(2) != value) allApplied = false;
+    totalUs += us;
+    if (us > worstUs) worstUs = us;
+    runUntilIdle(link, boards);  // Let the ack arrive before the next sample
+  }
+  unsigned long avgUs = totalUs / samples;
+  std::printf("  %s: latency avg %lu us, worst %lu us (%d samples)\n", label, avgUs, worstUs, samples);
+  check(allApplied, "every value applied");
+  checkClean(link, boards);
+}
+
+int main() {
+  HostSim::setSerialQuiet(true);
+  testLoopback();
+  testDroppedFrames();
+  testMasterRestart();
+  testLinkLoss();
+  testNoisyLine();
+
+  std::printf("Benchmarks\n");
+  // One 4-command frame (20 bytes) and its ack (3 bytes) per round trip:
+  // 960 bytes/s at 9600 baud allow about 160 commands/s
+  benchThroughput("socket", 0, 1000);
+  benchThroughput("9600 baud", 9600, 2000);
+  // One 1-command frame is 8 bytes = 8.3 ms at 9600 baud
+  benchLatency("socket", 0, 1000);
+  benchLatency("9600 baud", 9600, 20);
+
+  return finish("RemoteLinkTest");
+}
@@ -0,0 +1,120 @@
+/*
+ * SocketStream.h
+ *
+ * Arduino Stream over one end of a POSIX socketpair, so a master and a
+ * satellite can talk to each other inside one host test. Reads never
+ * block, like Serial.read().
+ *
+ * Options, for the sending side of each end:
+ * - setBaud(): bytes leave at most one per 10 bits at that baud rate on
+ *   the wall clock, as over a UART. 0 (default) = as fast as the socket.
+ * - corruptEvery(n): every n-th byte sent is inverted (line noise).
+ * - dropNext(n): the next n bytes sent are lost (a frame or ack that
+ *   never arrives).
+ *
+ * Needs HostSim::useRealTime(true) when a baud rate is set.
+ */
+
+#ifndef SOCKETSTREAM_H
+#define SOCKETSTREAM_H
+
+#include <Arduino.h>
+#include <deque>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+class SocketStream : public Stream {
+  private:
+    int fd;
+    unsigned long charUs;            // Time per byte; 0 = unpaced
+    unsigned long long lineFreeUs;   // When the last queued byte is sent
+    std::deque<uint8_t> txQueue;     // Written but not yet on the wire
+    std::deque<unsigned long long> txDueUs;
+    unsigned long corruptPeriod;
+    unsigned long dropCount;
+    unsigned long bytesWritten;
+    int peeked;                      // Byte read by peek(), -1 = none
+
+    // Put the bytes whose time has come into the socket
+    void pump() {
+      unsigned long long now = HostSim::nowUs();
+      while (!txQueue.empty() && txDueUs.front() <= now) {
+        uint8_t b = txQueue.front();
+        if (::write(fd, &b, 1) != 1) break;
+        txQueue.pop_front();
+        txDueUs.pop_front();
+      }
+    }
+
+  public:
+    explicit SocketStream(int socketFd)
+      : fd(socketFd), charUs(0), lineFreeUs(0), corruptPeriod(0), dropCount(0), bytesWritten(0), peeked(-1) {
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    ~SocketStream() { ::close(fd); }
+
+    // Connected pair: what one end writes, the other reads
+    static bool pair(SocketStream*& a, SocketStream*& b) {
+      int fds[2];
+      if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) return false;
+      a = new SocketStream(fds[0]);
+      b = new SocketStream(fds[1]);
+      return true;
+    }
+
+    void setBaud(unsigned long baud) { charUs = baud > 0 ? 10000000UL / baud : 0; }
+    void corruptEvery(unsigned long n) { corruptPeriod = n; }
+    void dropNext(unsigned long n) { dropCount = n; }
+    unsigned long getBytesWritten() { return bytesWritten; }
+
+    size_t write(uint8_t b) override {
+      bytesWritten++;
+      if (dropCount > 0) {
+        dropCount--;
+        return 1;  // Sent, but lost on the line
+      }
+      if (corruptPeriod > 0 && bytesWritten % corruptPeriod == 0) b = ~b;
+      if (charUs == 0 && txQueue.empty()) {
+        return ::write(fd, &b, 1) == 1 ? 1 : 0;
+      }
+      unsigned long long now = HostSim::nowUs();
+      lineFreeUs = (lineFreeUs > now ? lineFreeUs : now) + charUs;
+      txQueue.push_back(b);
+      txDueUs.push_back(lineFreeUs);
+      return 1;
+    }
+    using Print::write;
+
+    int available() override {
+      pump();
+      int n = 0;
+      if (ioctl(fd, FIONREAD, &n) != 0) n = 0;
+      return n + (peeked >= 0 ? 1 : 0);
+    }
+
+    int read() override {
+      pump();
+      if (peeked >= 0) {
+        int b = peeked;
+        peeked = -1;
+        return b;
+      }
+      uint8_t b;
+      return ::read(fd, &b, 1) == 1 ? b : -1;
+    }
+
+    int peek() override {
+      if (peeked < 0) peeked = read();
+      return peeked;
+    }
+
+    // Wait until every queued byte is in the socket
+    void flush() override {
+      while (!txQueue.empty()) pump();
+    }
+};
+
+#endif
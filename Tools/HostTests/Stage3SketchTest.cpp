@@ -0,0 +1,118 @@
+/*
+ * Stage3SketchTest.cpp
+ *
+ * Runs Stage3.ino on the host with Serial at a simulated 9600 baud (each
+ * character beyond the 64-byte buffer blocks for 1.04 ms, as on the Uno).
+ *
+ * Checks:
+ * - The first pin calls of the boot make the motor, fan and servo pins
+ *   (5, 6, 9) LOW outputs, before any other pin is touched.
+ * - The critical boot phase meets the sketch's 2 ms budget.
+ * - No loop() iteration overruns its 50 ms budget while the banner, the
+ *   demonstration, the help text and the long reports are printed.
+ * - Once the fail-safe is latched, the demonstration does not switch any
+ *   actuator on again, and neither does interactive mode.
+ */
+
+#include <Arduino.h>
+#include <Servo.h>
+#include "DeadlineMonitor.h"
+#include "BootSequencer.h"
+#include "HostTest.h"
+
+// From the sketch
+void setup();
+void loop();
+extern DeadlineMonitor monitor;
+extern BootSequencer boot;
+extern int loopTask;
+extern int bootTask;
+
+static const unsigned long BOOT_BUDGET_US = 2000;  // As in Stage3.ino
+
+static const int MOTOR_PIN = 5;
+static const int FAN_PIN = 6;
+static const int SERVO_PIN = 9;
+
+static bool anyActuatorOn() {
+  return HostSim::getOutput(MOTOR_PIN) != 0 || HostSim::getOutput(FAN_PIN) != 0 ||
+         Servo::attachedCount() > 0;
+}
+
+// Run loop() for the given simulated time; false if an actuator was on
+// at the end of any iteration
+static bool runFor(unsigned long ms) {
+  bool stayedOff = true;
+  unsigned long long endUs = HostSim::nowUs() + ms * 1000ULL;
+  while (HostSim::nowUs() < endUs) {
+    loop();
+    if (anyActuatorOn()) stayedOff = false;
+  }
+  return stayedOff;
+}
+
+static bool printed(const char* text) {
+  return HostSim::serialOutput().find(text) != std::string::npos;
+}
+
+int main() {
+  HostSim::setSerialQuiet(true);
+  HostSim::reset();
+  setup();
+
+  std::printf("Boot\n");
+  // Each pin takes a digitalWrite() and a pinMode(): 6 calls for the three
+  bool lowFirst = true;
+  const int pins[] = {MOTOR_PIN, FAN_PIN, SERVO_PIN};
+  for (int pin : pins) {
+    unsigned long call = HostSim::getFirstLowOutputCall(pin);
+    if (call == 0 || call > 6) lowFirst = false;
+  }
+  check(lowFirst, "pins 5, 6 and 9 LOW outputs before any other pin call");
+  std::printf("  time to first control %lu us\n", boot.getTimeToFirstControlUs());
+  check(boot.metBudget(BOOT_BUDGET_US), "critical phase within the boot budget");
+  check(monitor.getOverruns(bootTask) == 0, "no boot overrun recorded by the monitor");
+  check(!anyActuatorOn(), "all actuators off after boot");
+
+  std::printf("Demonstration until the fail-safe trips\n");
+  runFor(1500);
+  check(printed("Stage 3: Factory Design Pattern"), "banner printed");
+  check(HostSim::getOutput(MOTOR_PIN) == 150, "demo motor runs at 150 while the fail-safe is armed");
+
+  // A stalled task trips the fail-safe in the middle of the demonstration
+  int stall = monitor.addTask("stall", 1000);
+  for (int i = 0; i < 3; i++) {
+    monitor.beginTask(stall);
+    HostSim::advanceUs(5000);
+    monitor.endTask(stall);
+  }
+  check(monitor.isFailSafeTripped(), "fail-safe tripped");
+  check(!anyActuatorOn(), "demo motor stopped");
+
+  bool stayedOff = runFor(25000);
+  check(boot.isComplete(), "demonstration and help text finished");
+  check(printed("Interactive Mode Starting"), "help text printed");
+  check(printed("Fail-safe latched - stays off"), "demo reports the latch");
+  check(stayedOff, "no actuator switched on while latched");
+
+  std::printf("Interactive commands\n");
+  HostSim::serialInput("a");
+  stayedOff = runFor(500);
+  check(stayedOff && printed("Fail-safe latched - send 'r'"), "'a' refused while latched");
+
+  HostSim::serialInput("ra");
+  runFor(500);
+  check(!monitor.isFailSafeTripped() && Servo::attachedCount() == 1, "'r' then 'a' activates the servo");
+
+  HostSim::serialInput("sm1a++sm3am2sm");
+  runFor(3000);
+  check(printed("--- Actuator Status ---") && printed("--- Deadline Monitor ---"), "reports printed");
+  check(HostSim::getOutput(FAN_PIN) == 0 && HostSim::getOutput(MOTOR_PIN) == 0, "replaced actuators are off");
+
+  std::printf("Loop budget\n");
+  std::printf("  loop: runs=%lu worst=%lu us overruns=%lu\n", monitor.getRuns(loopTask),
+              monitor.getWorstUs(loopTask), monitor.getOverruns(loopTask));
+  check(monitor.getOverruns(loopTask) == 0, "no loop overrun at 9600 baud");
+
+  return finish("Stage3SketchTest");
+}
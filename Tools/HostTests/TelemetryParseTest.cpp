@@ -0,0 +1,147 @@
+/*
+ * TelemetryParseTest.cpp
+ *
+ * Host test of the TelemetryAnalyzer text parser (Tools/TelemetryAnalyzer):
+ * which Stage 4 Serial lines it accepts, the 16-bit value range, labels,
+ * truncated and CRLF lines, and that the parsed columns are the same for
+ * any thread count.
+ */
+
+#include <cstring>
+#include <string>
+#include "Telemetry.h"
+#include "HostTest.h"
+
+using namespace telemetry;
+
+static Columns parse(const std::string& text, unsigned threads = 1) {
+  return parseCapture(text.data(), text.size(), threads);
+}
+
+// One line on its own: accepted with these four values, or rejected
+static bool parsesAs(const char* line, int temp, int light, int pwm, int stored) {
+  Columns columns = parse(line);
+  return columns.size() == 1 &&
+         columns.data[TEMP][0] == temp && columns.data[LIGHT][0] == light &&
+         columns.data[PWM][0] == pwm && columns.data[STORED][0] == stored &&
+         columns.data[INPUT][0] == (temp + light) / 2;
+}
+
+static bool rejects(const char* line) {
+  return parse(line).size() == 0;
+}
+
+static void testRange() {
+  std::printf("16-bit value range\n");
+  check(parsesAs("Temp:512  Light:300  PWM:103  Stored:103\n", 512, 300, 103, 103), "sketch line");
+  check(parsesAs("Temp:32767  Light:-32768  PWM:0  Stored:-1\n", 32767, -32768, 0, -1),
+        "32767 and -32768 accepted");
+  check(parsesAs("Temp:-32768  Light:-32768  PWM:32767  Stored:32767\n", -32768, -32768, 32767, 32767),
+        "(temp + light) / 2 at the bottom of the range");
+  check(rejects("Temp:32768  Light:0  PWM:0  Stored:0\n"), "32768 rejected");
+  check(rejects("Temp:0  Light:-32769  PWM:0  Stored:0\n"), "-32769 rejected");
+  check(rejects("Temp:0  Light:0  PWM:0  Stored:65536\n"), "65536 rejected (wraps to 0 in 16 bits)");
+}
+
+static void testLongDigitRuns() {
+  std::printf("Overlong digit runs\n");
+  check(rejects("Temp:99999999999999999999  Light:0  PWM:0  Stored:0\n"), "20 nines rejected");
+  check(rejects("Temp:0  Light:0  PWM:0  Stored:-4294967296\n"), "-2^32 rejected (wraps to 0 in 32 bits)");
+  check(rejects("Temp:0  Light:0  PWM:0  Stored:2147483648\n"), "2^31 rejected");
+  check(parsesAs("Temp:00000000000000000001  Light:-0000000000032768  PWM:0  Stored:0\n", 1, -32768, 0, 0),
+        "leading zeros do not count against the range");
+}
+
+static void testTruncatedLines() {
+  std::printf("Truncated lines\n");
+  check(rejects("Temp:512  Light:300  PWM:103\n"), "missing last field");
+  check(rejects("Temp:512  Light:300  PWM:103  Stored:\n"), "label without value");
+  check(rejects("Temp:512  Light:300  PWM:103  Stored:-\n"), "sign without digits");
+  check(rejects("Temp:512  Light:300  PWM:10"), "cut off at end of file");
+  check(parsesAs("Temp:512  Light:300  PWM:103  Stored:103", 512, 300, 103, 103),
+        "complete last line without newline");
+  check(rejects("Temp:512  Light:300  PWM:103  Stored:103ms\n"), "trailing text after the last value");
+  check(rejects("Temp:512  Light:300  PWM:103  Sto"), "cut off inside a label");
+
+  Columns columns = parse("Temp:1  Light:2  PWM:3  Stored:4\nTemp:5  Light:6\nTemp:7  Light:8  PWM:9  Stored:10\n");
+  check(columns.size() == 2 && columns.data[TEMP][1] == 7, "lines around a truncated one still parsed");
+}
+
+static void testLabels() {
+  std::printf("Labels\n");
+  check(rejects("Temp:512  Lux:300  PWM:103  Stored:103\n"), "wrong second label");
+  check(rejects("Temp:512  Light:300  Duty:103  Stored:103\n"), "wrong third label");
+  check(rejects("Temp:512  Light:300  PWM:103  Saved:103\n"), "wrong fourth label");
+  check(rejects("Temp:512  PWM:103  Light:300  Stored:103\n"), "labels out of order");
+  check(rejects("Temp:512Light:300  PWM:103  Stored:103\n"), "no separator between fields");
+  check(rejects("ERROR: Temp:512 Light:300 PWM:103 Stored:103\n"), "prefix before Temp:");
+  check(parsesAs("Temp:512\tLight:300 PWM:103    Stored:103  \n", 512, 300, 103, 103),
+        "any run of spaces or tabs between fields");
+}
+
+static void testCrLf() {
+  std::printf("CRLF line endings (Serial.println)\n");
+  check(parsesAs("Temp:512  Light:300  PWM:103  Stored:103\r\n", 512, 300, 103, 103), "CRLF line");
+  check(parsesAs("Temp:512  Light:300  PWM:103  Stored:-1\r\n", 512, 300, 103, -1), "CRLF after a negative value");
+  Columns columns = parse("Motor ready\r\nTemp:1  Light:2  PWM:3  Stored:4\r\n\r\nTemp:5  Light:6  PWM:7  Stored:8\r\n");
+  check(columns.size() == 2 && columns.data[STORED][0] == 4 && columns.data[STORED][1] == 8,
+        "CRLF capture with a banner and a blank line");
+}
+
+// A capture with good lines mixed with every kind of bad one, long enough
+// that parseCapture() splits it across up to 8 threads (one per 4 KB)
+static std::string mixedCapture(int lines) {
+  static const char* const BAD[] = {
+    "Motor ready\r\n",
+    "Temp:32768  Light:0  PWM:0  Stored:0\n",
+    "Temp:1  Light:2  PWM:3\r\n",
+    "Temp:1  Lux:2  PWM:3  Stored:4\n",
+    "\n",
+  };
+  std::string text;
+  char line[64];
+  for (int i = 0; i < lines; i++) {
+    if (i % 7 == 3) {
+      text += BAD[(i / 7) % 5];
+      continue;
+    }
+    std::snprintf(line, sizeof(line), "Temp:%d  Light:%d  PWM:%d  Stored:%d%s",
+                  (i * 37) % 1024, 1023 - (i * 11) % 1024, (i * 5) % 256, -(i % 3),
+                  (i % 2) ? "\r\n" : "\n");
+    text += line;
+  }
+  text += "Temp:1  Light:2  PWM:3  Stor";  // Cut off at the end
+  return text;
+}
+
+static void testThreadCounts() {
+  const int LINES = 20000;
+  std::string text = mixedCapture(LINES);
+  std::printf("Same columns for 1-8 threads (%zu bytes)\n", text.size());
+
+  Columns single = parse(text, 1);
+  int expected = 0;
+  for (int i = 0; i < LINES; i++) {
+    if (i % 7 != 3) expected++;
+  }
+  check(single.size() == (size_t)expected, "every good line parsed once, every bad one skipped");
+
+  bool same = true;
+  for (unsigned threads = 2; threads <= 8; threads++) {
+    Columns columns = parse(text, threads);
+    for (int c = 0; c < CHANNEL_COUNT; c++) {
+      if (columns.data[c] != single.data[c]) same = false;
+    }
+  }
+  check(same, "identical columns, in file order, for 2-8 threads");
+}
+
+int main() {
+  testRange();
+  testLongDigitRuns();
+  testTruncatedLines();
+  testLabels();
+  testCrLf();
+  testThreadCounts();
+  return finish("TelemetryParseTest");
+}
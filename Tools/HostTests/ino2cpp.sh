@@ -0,0 +1,17 @@
+#!/bin/sh
+# Turn a sketch into C++ the way the Arduino IDE does: add <Arduino.h> and
+# a prototype for every function after the sketch's #includes, so functions
+# can be used before they are defined.
+# Usage: ./ino2cpp.sh Sketch.ino output.cpp
+set -eu
+ino=$1
+out=$2
+last=$(grep -n '^#include' "$ino" | tail -1 | cut -d: -f1)
+{
+  echo '#include <Arduino.h>'
+  echo "#line 1 \"$ino\""
+  head -n "$last" "$ino"
+  grep -E '^[A-Za-z_][A-Za-z0-9_<>*& ]* [*&]?[A-Za-z_][A-Za-z0-9_]*\([^;]*\) *\{' "$ino" | sed 's/ *{.*$/;/'
+  echo "#line $((last + 1)) \"$ino\""
+  tail -n +"$((last + 1))" "$ino"
+} > "$out"
@@ -0,0 +1,94 @@
+#!/bin/sh
+# Build and run every host test. Usage: ./run_tests.sh [test-name ...]
+# Exit code is non-zero if any test fails to build or run.
+
+set -u
+cd "$(dirname "$0")"
+CXX=${CXX:-g++}
+FLAGS="-std=gnu++11 -O2 -Wall -Wextra -Istub"
+OUT=${OUT:-build}
+mkdir -p "$OUT"
+
+STAGE2=../../Stage2-InheritanceAndPolymorphism
+STAGE3=../../Stage3-FactoryPattern
+STAGE4=../../Stage4-DebuggingRefactoring
+TELEMETRY=../TelemetryAnalyzer
+
+build() {
+  name=$1; shift
+  $CXX $FLAGS "$@" stub/Arduino.cpp -o "$OUT/$name"
+}
+
+# Sketch as the Arduino IDE compiles it (see ino2cpp.sh)
+sketch() {
+  ./ino2cpp.sh "$1" "$OUT/$(basename "$1" .ino).cpp"
+  echo "$OUT/$(basename "$1" .ino).cpp"
+}
+
+# Each stage folder is a separate sketch, so Stages 2 and 4 carry their
+# own copy of IdleManager and WatchdogHook; they must not drift apart
+same_as_stage3() {
+  for f in IdleManager.h IdleManager.cpp WatchdogHook.h WatchdogHook.cpp; do
+    cmp "$STAGE3/$f" "$1/$f" || return 1
+  done
+}
+
+ACTUATORS="$STAGE3/Actuator.cpp $STAGE3/MotorActuator.cpp $STAGE3/ServoActuator.cpp $STAGE3/FanActuator.cpp"
+
+# name: how to build it
+build_test() {
+  case $1 in
+    IdleManagerSim)
+      build IdleManagerSim -D__AVR__ -I$STAGE3 IdleManagerSim.cpp $STAGE3/IdleManager.cpp \
+        $STAGE3/WatchdogHook.cpp $STAGE3/DeadlineMonitor.cpp stub/AvrSim.cpp ;;
+    IdleManagerSimStage2)
+      same_as_stage3 $STAGE2 && build IdleManagerSimStage2 -D__AVR__ -I$STAGE2 IdleManagerSim.cpp $STAGE2/IdleManager.cpp \
+        $STAGE2/WatchdogHook.cpp stub/AvrSim.cpp ;;
+    IdleManagerSimStage4)
+      same_as_stage3 $STAGE4 && build IdleManagerSimStage4 -D__AVR__ -I$STAGE4 IdleManagerSim.cpp $STAGE4/IdleManager.cpp \
+        $STAGE4/WatchdogHook.cpp stub/AvrSim.cpp ;;
+    QuadratureEncoderTest)
+      build QuadratureEncoderTest -I$STAGE3 QuadratureEncoderTest.cpp \
+        $STAGE3/QuadratureEncoder.cpp $STAGE3/MotorActuator.cpp $STAGE3/Actuator.cpp ;;
+    QuickTest)
+      build QuickTest -I$STAGE3 "$(sketch $STAGE3/QuickTest.ino)" stub/SketchMain.cpp \
+        $ACTUATORS $STAGE3/DeadlineMonitor.cpp $STAGE3/QuadratureEncoder.cpp $STAGE3/WatchdogHook.cpp ;;
+    BootSequencerTest)
+      build BootSequencerTest -I$STAGE3 BootSequencerTest.cpp $STAGE3/BootSequencer.cpp ;;
+    Stage3SketchTest)
+      build Stage3SketchTest -I$STAGE3 "$(sketch $STAGE3/Stage3.ino)" Stage3SketchTest.cpp \
+        $ACTUATORS $STAGE3/DeadlineMonitor.cpp $STAGE3/QuadratureEncoder.cpp \
+        $STAGE3/IdleManager.cpp $STAGE3/BootSequencer.cpp $STAGE3/WatchdogHook.cpp ;;
+    RemoteLinkTest)
+      build RemoteLinkTest -I$STAGE3 RemoteLinkTest.cpp $STAGE3/RemoteLink.cpp \
+        $STAGE3/RemoteActuator.cpp $STAGE3/RemoteActuatorServer.cpp $ACTUATORS \
+        $STAGE3/QuadratureEncoder.cpp ;;
+    RemoteMaster)
+      build RemoteMaster -I$STAGE3 "$(sketch $STAGE3/RemoteMaster.ino)" stub/SketchMain.cpp \
+        $STAGE3/RemoteLink.cpp $STAGE3/RemoteActuator.cpp $STAGE3/Actuator.cpp ;;
+    RemoteSatellite)
+      build RemoteSatellite -I$STAGE3 "$(sketch $STAGE3/RemoteSatellite.ino)" stub/SketchMain.cpp \
+        $STAGE3/RemoteActuatorServer.cpp $ACTUATORS $STAGE3/QuadratureEncoder.cpp ;;
+    DataflowBench)
+      build DataflowBench -I$STAGE4 DataflowBench.cpp ;;
+    TelemetryParseTest)
+      build TelemetryParseTest -std=gnu++17 -pthread -I$TELEMETRY TelemetryParseTest.cpp \
+        $TELEMETRY/Telemetry.cpp ;;
+    *)
+      echo "unknown test: $1"; return 1 ;;
+  esac
+}
+
+TESTS=${*:-"IdleManagerSim IdleManagerSimStage2 IdleManagerSimStage4 QuadratureEncoderTest QuickTest BootSequencerTest Stage3SketchTest RemoteLinkTest RemoteMaster RemoteSatellite DataflowBench TelemetryParseTest"}
+failed=0
+for t in $TESTS; do
+  echo "=== $t ==="
+  if build_test "$t" && "./$OUT/$t"; then :; else
+    echo "*** $t FAILED"
+    failed=$((failed + 1))
+  fi
+  echo
+done
+
+echo "$failed test(s) failed"
+exit $failed
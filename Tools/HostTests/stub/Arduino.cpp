@@ -0,0 +1,389 @@
+/*
+ * Arduino.cpp (host stub)
+ *
+ * Implementation of the host Arduino core (see Arduino.h).
+ */
+
+#include "Arduino.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+HardwareSerial Serial;
+
+// Millisecond counter and Timer0 overflow count (the base of micros()),
+// as in the AVR core (wiring.c). IdleManager adds the time spent in
+// power-down to both, exactly as it does on the board.
+volatile unsigned long timer0_millis = 0;
+volatile unsigned long timer0_overflow_count = 0;
+
+namespace {
+  bool realTime = false;
+  std::chrono::steady_clock::time_point realStart = std::chrono::steady_clock::now();
+
+  unsigned long long trueUs = 0;     // Real (simulated) time
+  const unsigned long OVERFLOW_US = 1024;  // 256 Timer0 ticks of 4 us
+  unsigned long overflowFractUs = 0; // Time since the last Timer0 overflow
+  unsigned long timer0FractUs = 0;   // Part of a millisecond not yet counted
+
+  int modes[NUM_PINS];
+  int outputs[NUM_PINS];
+  int inputs[NUM_PINS];
+  int analogInputs[NUM_PINS];
+  volatile uint8_t inputRegisters[NUM_PINS];
+  unsigned long analogReads = 0;
+  unsigned long analogWrites = 0;
+  unsigned long pinCalls = 0;
+  unsigned long firstLowOutputCall[NUM_PINS];
+
+  // Count one pin call and note when the pin first drives LOW
+  void countPinCall(int pin) {
+    pinCalls++;
+    if (firstLowOutputCall[pin] == 0 && modes[pin] == OUTPUT && outputs[pin] == LOW) {
+      firstLowOutputCall[pin] = pinCalls;
+    }
+  }
+
+  void (*isrs[2])() = {nullptr, nullptr};
+  int isrModes[2] = {0, 0};
+  bool interruptsHeld = false;
+  bool isrPending[2] = {false, false};
+
+  const int SERIAL_TX_BUFFER = 64;        // As in the AVR core
+  unsigned long serialCharUs = 0;         // 0 = no baud rate emulation
+  unsigned long long serialIdleAtUs = 0;  // When the last queued byte is sent
+
+  bool serialQuiet = false;
+  std::string serialIn;
+  std::string serialOut;
+
+  unsigned long long realUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - realStart).count();
+  }
+}
+
+// --- Time ---
+
+unsigned long millis() {
+  if (realTime) return (unsigned long)(realUs() / 1000);
+  return timer0_millis;
+}
+
+unsigned long micros() {
+  if (realTime) return (unsigned long)realUs();
+  return timer0_overflow_count * OVERFLOW_US + overflowFractUs;
+}
+
+void delay(unsigned long ms) {
+  if (realTime) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+  } else {
+    HostSim::advanceUs((unsigned long long)ms * 1000);
+  }
+}
+
+void delayMicroseconds(unsigned int us) {
+  if (realTime) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+  } else {
+    HostSim::advanceUs(us);
+  }
+}
+
+// --- Pins ---
+
+void pinMode(int pin, int mode) {
+  if (pin < 0 || pin >= NUM_PINS) return;
+  modes[pin] = mode;
+  if (mode == INPUT_PULLUP && inputs[pin] == 0) {
+    HostSim::setInput(pin, HIGH);
+  }
+  countPinCall(pin);
+}
+
+void digitalWrite(int pin, int value) {
+  if (pin < 0 || pin >= NUM_PINS) return;
+  outputs[pin] = value;
+  countPinCall(pin);
+  if (modes[pin] == OUTPUT) {
+    HostSim::setInput(pin, value);  // As on AVR: the pin reads back, and INT0/1 fire
+  }
+}
+
+int digitalRead(int pin) {
+  return (pin >= 0 && pin < NUM_PINS) ? inputs[pin] : LOW;
+}
+
+void analogWrite(int pin, int value) {
+  analogWrites++;
+  if (pin < 0 || pin >= NUM_PINS) return;
+  outputs[pin] = value;
+  countPinCall(pin);
+}
+
+int analogRead(int pin) {
+  analogReads++;
+  if (pin >= 0 && pin < 6) pin += A0;  // analogRead(0) means A0
+  return (pin >= 0 && pin < NUM_PINS) ? analogInputs[pin] : 0;
+}
+
+long map(long x, long inLo, long inHi, long outLo, long outHi) {
+  return (x - inLo) * (outHi - outLo) / (inHi - inLo) + outLo;
+}
+
+unsigned long pulseIn(int, int, unsigned long) {
+  return 0;  // No echo
+}
+
+// --- Interrupts ---
+
+int digitalPinToInterrupt(int pin) {
+  if (pin == 2) return 0;
+  if (pin == 3) return 1;
+  return NOT_AN_INTERRUPT;
+}
+
+void attachInterrupt(int interrupt, void (*isr)(), int mode) {
+  if (interrupt < 0 || interrupt > 1) return;
+  isrs[interrupt] = isr;
+  isrModes[interrupt] = mode;
+}
+
+void detachInterrupt(int interrupt) {
+  if (interrupt >= 0 && interrupt <= 1) isrs[interrupt] = nullptr;
+}
+
+volatile uint8_t* portInputRegister(int port) {
+  return &inputRegisters[port];
+}
+
+int digitalPinToPort(int pin) {
+  return pin;
+}
+
+uint8_t digitalPinToBitMask(int) {
+  return 1;
+}
+
+// --- String ---
+
+void String::toLowerCase() {
+  std::transform(begin(), end(), begin(), [](unsigned char c) { return (char)std::tolower(c); });
+}
+
+void String::toUpperCase() {
+  std::transform(begin(), end(), begin(), [](unsigned char c) { return (char)std::toupper(c); });
+}
+
+void String::trim() {
+  size_t first = find_first_not_of(" \t\r\n");
+  size_t last = find_last_not_of(" \t\r\n");
+  *this = (first == npos) ? String() : String(substr(first, last - first + 1));
+}
+
+int String::toInt() const {
+  return std::atoi(c_str());
+}
+
+// --- Print ---
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  for (size_t i = 0; i < size; i++) write(buffer[i]);
+  return size;
+}
+
+size_t Print::write(const char* s) {
+  return write((const uint8_t*)s, std::char_traits<char>::length(s));
+}
+
+size_t Print::print(const char* s) { return write(s); }
+size_t Print::print(const String& s) { return write(s.c_str()); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+size_t Print::print(int value, int base) { return print((long)value, base); }
+size_t Print::print(unsigned int value, int base) { return print((unsigned long)value, base); }
+
+size_t Print::print(long value, int base) {
+  char text[24];
+  std::snprintf(text, sizeof(text), base == HEX ? "%lX" : "%ld", value);
+  return write(text);
+}
+
+size_t Print::print(unsigned long value, int base) {
+  char text[24];
+  std::snprintf(text, sizeof(text), base == HEX ? "%lX" : "%lu", value);
+  return write(text);
+}
+
+size_t Print::print(double value, int digits) {
+  char text[48];
+  std::snprintf(text, sizeof(text), "%.*f", digits, value);
+  return write(text);
+}
+
+size_t Print::println() {
+  return write("\r\n");
+}
+
+// --- Serial ---
+
+// Bytes still waiting in the transmit buffer (simulated time only)
+static int serialQueued() {
+  if (serialCharUs == 0 || serialIdleAtUs <= trueUs) return 0;
+  return (int)((serialIdleAtUs - trueUs + serialCharUs - 1) / serialCharUs);
+}
+
+void HardwareSerial::begin(unsigned long baud) {
+  serialCharUs = baud ? 10000000UL / baud : 0;  // 10 bits per character
+  serialIdleAtUs = trueUs;
+}
+
+size_t HardwareSerial::write(uint8_t b) {
+  if (!realTime && serialCharUs > 0) {
+    // Buffer full: wait until one more byte fits
+    int excess = serialQueued() - (SERIAL_TX_BUFFER - 1);
+    if (excess > 0) {
+      HostSim::advanceUs(serialIdleAtUs - (SERIAL_TX_BUFFER - 1) * (unsigned long long)serialCharUs - trueUs);
+    }
+    serialIdleAtUs = std::max(serialIdleAtUs, trueUs) + serialCharUs;
+  }
+  serialOut += (char)b;
+  if (!serialQuiet && b != '\r') std::putchar(b);
+  return 1;
+}
+
+int HardwareSerial::available() {
+  return (int)serialIn.size();
+}
+
+int HardwareSerial::read() {
+  if (serialIn.empty()) return -1;
+  int b = (uint8_t)serialIn[0];
+  serialIn.erase(0, 1);
+  return b;
+}
+
+void HardwareSerial::flush() {
+  if (!realTime && serialIdleAtUs > trueUs) {
+    HostSim::advanceUs(serialIdleAtUs - trueUs);
+  }
+}
+
+int HardwareSerial::availableForWrite() {
+  return SERIAL_TX_BUFFER - serialQueued();
+}
+
+int HardwareSerial::peek() {
+  return serialIn.empty() ? -1 : (uint8_t)serialIn[0];
+}
+
+// --- Test controls ---
+
+namespace HostSim {
+  void useRealTime(bool real) {
+    realTime = real;
+    realStart = std::chrono::steady_clock::now();
+  }
+
+  void advanceUs(unsigned long long us) {
+    trueUs += us;
+    unsigned long long sinceOverflowUs = overflowFractUs + us;
+    timer0_overflow_count += (unsigned long)(sinceOverflowUs / OVERFLOW_US);
+    overflowFractUs = (unsigned long)(sinceOverflowUs % OVERFLOW_US);
+    timer0FractUs += (unsigned long)us % 1000;
+    timer0_millis += (unsigned long)(us / 1000) + timer0FractUs / 1000;
+    timer0FractUs %= 1000;
+  }
+
+  void advanceAsleepUs(unsigned long long us) {
+    trueUs += us;
+  }
+
+  unsigned long long nowUs() {
+    return realTime ? realUs() : trueUs;
+  }
+
+  unsigned long usUntilMillisTick() {
+    return 1000 - timer0FractUs;
+  }
+
+  void reset() {
+    trueUs = 0;
+    overflowFractUs = 0;
+    timer0_overflow_count = 0;
+    timer0FractUs = 0;
+    timer0_millis = 0;
+    for (int i = 0; i < NUM_PINS; i++) {
+      modes[i] = INPUT;
+      outputs[i] = 0;
+      inputs[i] = 0;
+      analogInputs[i] = 0;
+      inputRegisters[i] = 0;
+      firstLowOutputCall[i] = 0;
+    }
+    analogReads = 0;
+    analogWrites = 0;
+    pinCalls = 0;
+    isrs[0] = isrs[1] = nullptr;
+    interruptsHeld = false;
+    isrPending[0] = isrPending[1] = false;
+    serialIn.clear();
+    serialOut.clear();
+    serialCharUs = 0;
+    serialIdleAtUs = 0;
+  }
+
+  void setInput(int pin, int level) {
+    if (pin < 0 || pin >= NUM_PINS) return;
+    int previous = inputs[pin];
+    inputs[pin] = level ? HIGH : LOW;
+    inputRegisters[pin] = (uint8_t)inputs[pin];
+
+    int interrupt = digitalPinToInterrupt(pin);
+    if (interrupt == NOT_AN_INTERRUPT || isrs[interrupt] == nullptr) return;
+    int mode = isrModes[interrupt];
+    bool fire = (mode == CHANGE && previous != inputs[pin]) ||
+                (mode == RISING && previous == LOW && inputs[pin] == HIGH) ||
+                (mode == FALLING && previous == HIGH && inputs[pin] == LOW);
+    if (!fire) return;
+    if (interruptsHeld) {
+      isrPending[interrupt] = true;  // Further edges are lost, as on AVR
+    } else {
+      isrs[interrupt]();
+    }
+  }
+
+  void holdInterrupts(bool hold) {
+    interruptsHeld = hold;
+    if (hold) return;
+    for (int i = 0; i < 2; i++) {  // INT0 has priority over INT1
+      if (isrPending[i] && isrs[i] != nullptr) isrs[i]();
+      isrPending[i] = false;
+    }
+  }
+
+  void setAnalog(int pin, int value) {
+    if (pin >= 0 && pin < 6) pin += A0;
+    if (pin >= 0 && pin < NUM_PINS) analogInputs[pin] = value;
+  }
+
+  int getOutput(int pin) {
+    return (pin >= 0 && pin < NUM_PINS) ? outputs[pin] : 0;
+  }
+
+  unsigned long getAnalogReads() { return analogReads; }
+  unsigned long getAnalogWrites() { return analogWrites; }
+
+  unsigned long getFirstLowOutputCall(int pin) {
+    return (pin >= 0 && pin < NUM_PINS) ? firstLowOutputCall[pin] : 0;
+  }
+
+  void setSerialQuiet(bool quiet) { serialQuiet = quiet; }
+  void serialInput(const char* text) { serialIn += text; }
+  const std::string& serialOutput() { return serialOut; }
+  void clearSerialOutput() { serialOut.clear(); }
+}
@@ -0,0 +1,179 @@
+/*
+ * Arduino.h (host stub)
+ *
+ * Just enough of the Arduino core to compile the sketch classes on a PC
+ * and drive them from a test program. Not a full emulator:
+ * - millis()/micros() come from a simulated clock that only moves when a
+ *   test (or delay()) advances it, so runs are repeatable. Tests that talk
+ *   over real sockets switch to the wall clock with HostSim::useRealTime().
+ * - Pins are plain arrays. Tests drive inputs with HostSim::setInput(),
+ *   which also runs the interrupt attached to that pin.
+ * - Serial prints to stdout unless HostSim::setSerialQuiet(true).
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+#if defined(__AVR__)
+#include <avr/io.h>  // Emulated registers (see avr/io.h in this folder)
+#endif
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define NOT_AN_INTERRUPT -1
+#define DEC 10
+#define HEX 16
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define NUM_PINS 20
+
+#define constrain(x, lo, hi) ((x) < (lo) ? (lo) : ((x) > (hi) ? (hi) : (x)))
+
+// --- Time ---
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// --- Pins ---
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int value);
+int digitalRead(int pin);
+void analogWrite(int pin, int value);
+int analogRead(int pin);
+long map(long x, long inLo, long inHi, long outLo, long outHi);
+unsigned long pulseIn(int pin, int state, unsigned long timeoutUs = 1000000UL);
+
+// --- Interrupts (Uno numbering: D2 = 0, D3 = 1) ---
+#if !defined(__AVR__)
+inline void noInterrupts() {}
+inline void interrupts() {}
+#else
+#define noInterrupts() cli()
+#define interrupts() sei()
+#endif
+int digitalPinToInterrupt(int pin);
+void attachInterrupt(int interrupt, void (*isr)(), int mode);
+void detachInterrupt(int interrupt);
+
+// Fast port access: one emulated 8-bit input register per pin
+volatile uint8_t* portInputRegister(int port);
+int digitalPinToPort(int pin);
+uint8_t digitalPinToBitMask(int pin);
+
+// --- String ---
+class String : public std::string {
+  public:
+    String() {}
+    String(const char* s) : std::string(s) {}
+    String(const std::string& s) : std::string(s) {}
+    String(int value) : std::string(std::to_string(value)) {}
+    String(long value) : std::string(std::to_string(value)) {}
+    String(unsigned long value) : std::string(std::to_string(value)) {}
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+    int toInt() const;
+};
+
+// --- Print / Stream ---
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* s);
+
+    size_t print(const char* s);
+    size_t print(const String& s);
+    size_t print(char c);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+
+    size_t println();
+    template <typename T> size_t println(const T& value) {
+      size_t n = print(value);
+      return n + println();
+    }
+    template <typename T> size_t println(const T& value, int format) {
+      size_t n = print(value, format);
+      return n + println();
+    }
+};
+
+class Stream : public Print {
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {}
+};
+
+class HardwareSerial : public Stream {
+  public:
+    void begin(unsigned long baud);
+    void end() {}
+    operator bool() { return true; }
+    size_t write(uint8_t b) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int peek() override;
+    void flush() override;       // Wait until everything has been sent
+    int availableForWrite();     // Free space in the transmit buffer
+};
+
+extern HardwareSerial Serial;
+
+// --- Test controls ---
+namespace HostSim {
+  // Clock
+  void useRealTime(bool real);           // Wall clock instead of simulated time
+  void advanceUs(unsigned long long us); // Simulated time passes, CPU awake
+  void advanceAsleepUs(unsigned long long us);  // Time passes, Timer0 stopped
+  unsigned long long nowUs();            // True time since the start
+  unsigned long usUntilMillisTick();    // Until Timer0 next advances millis()
+  void reset();                          // Clock, pins and Serial back to power-on
+
+  // Pins
+  void setInput(int pin, int level);     // Drive an input; runs its interrupt
+  void holdInterrupts(bool hold);        // Latch pin interrupts (one per pin, as
+                                         // on AVR) and run them on release
+  void setAnalog(int pin, int value);    // Value returned by analogRead()
+  int getOutput(int pin);                // Last digitalWrite()/analogWrite()
+  unsigned long getAnalogReads();        // analogRead() calls so far
+  unsigned long getAnalogWrites();       // analogWrite() calls so far
+  // Pin call (pinMode/digitalWrite/analogWrite on any pin, counted from 1)
+  // after which the pin was first an output at LOW; 0 = never
+  unsigned long getFirstLowOutputCall(int pin);
+
+  // Serial: in simulated time, writes take the time set by Serial.begin()
+  // (1.04 ms per character at 9600 baud) once the 64-byte transmit buffer
+  // is full, as on the Uno
+  void setSerialQuiet(bool quiet);       // Drop output instead of printing
+  void serialInput(const char* text);    // Bytes for Serial.read()
+  const std::string& serialOutput();     // Everything written to Serial
+  void clearSerialOutput();
+}
+
+#endif
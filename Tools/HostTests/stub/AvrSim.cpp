@@ -0,0 +1,187 @@
+/*
+ * AvrSim.cpp (host stub)
+ *
+ * Emulation of the ATmega328P watchdog timer and sleep modes, enough to
+ * run IdleManager's real AVR code on a PC:
+ * - IDLE: Timer0 keeps running; the CPU wakes on the next millisecond
+ *   tick or on a watchdog interrupt.
+ * - POWER-DOWN: Timer0 stops; the CPU wakes on a watchdog interrupt or
+ *   on an external interrupt, then waits 16K cycles for the oscillator.
+ * - In interrupt-and-reset mode (WDIE and WDE), the watchdog interrupt
+ *   clears WDIE; a second timeout would reset the chip.
+ * - A watchdog interrupt without an ISR(WDT_vect) restarts the chip.
+ */
+
+#include <Arduino.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+#include "AvrSim.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+volatile uint8_t SREG = _BV(SREG_I);   // The Arduino core enables interrupts
+volatile uint8_t WDTCSR = 0;
+volatile uint8_t MCUSR = 0;
+volatile uint8_t ADCSRA = _BV(ADEN);   // The Arduino core enables the ADC
+
+extern "C" void WDT_vect(void);
+
+namespace {
+  const unsigned long long NEVER = ~0ULL;
+  const unsigned long long STARTUP_US = 16384ULL * 1000000ULL / F_CPU;
+
+  uint8_t sleepMode = SLEEP_MODE_IDLE;
+  bool sleepEnabled = false;
+
+  double watchdogScale = 1.0;
+  unsigned long long watchdogStartUs = 0;  // Last wdt_reset() or timeout
+
+  unsigned long long externalMeanUs = 0;
+  unsigned long long nextExternalUs = NEVER;
+  std::mt19937 rng;
+
+  unsigned long powerDowns = 0;
+  unsigned long externalWakes = 0;
+  unsigned long watchdogResets = 0;
+
+  bool watchdogRunning() {
+    return (WDTCSR & (_BV(WDIE) | _BV(WDE))) != 0;
+  }
+
+  unsigned long long watchdogPeriodUs() {
+    int prescale = (WDTCSR & 0x07) | ((WDTCSR & _BV(WDP3)) ? 8 : 0);
+    return (unsigned long long)(16000.0 * (1 << prescale) * watchdogScale);
+  }
+
+  unsigned long long watchdogDueUs() {
+    return watchdogRunning() ? watchdogStartUs + watchdogPeriodUs() : NEVER;
+  }
+
+  void scheduleExternal(unsigned long long fromUs) {
+    if (externalMeanUs == 0) {
+      nextExternalUs = NEVER;
+      return;
+    }
+    std::exponential_distribution<double> gap(1.0 / externalMeanUs);
+    nextExternalUs = fromUs + 1 + (unsigned long long)gap(rng);
+  }
+
+  void watchdogTimeout() {
+    watchdogStartUs = watchdogDueUs();
+    if (WDTCSR & _BV(WDIE)) {
+      if (WDTCSR & _BV(WDE)) {
+        WDTCSR &= (uint8_t)~_BV(WDIE);  // Next timeout resets
+      }
+      uint8_t saved = SREG;
+      cli();
+      WDT_vect();
+      SREG = saved;
+    } else {
+      watchdogResets++;
+      std::fprintf(stderr, "AvrSim: watchdog reset\n");
+    }
+  }
+}
+
+// No watchdog handler: avr-libc's start-up code points every vector at
+// __bad_interrupt, which restarts the board. The program cannot go on
+// after that, so this weak default ends it; a sketch's ISR(WDT_vect)
+// replaces it.
+extern "C" __attribute__((weak)) void WDT_vect(void) {
+  std::fprintf(stderr, "AvrSim: watchdog interrupt without ISR(WDT_vect): the board restarts\n");
+  std::exit(2);
+}
+
+void wdt_reset() {
+  watchdogStartUs = HostSim::nowUs();
+}
+
+void set_sleep_mode(uint8_t mode) {
+  sleepMode = mode;
+}
+
+void sleep_enable() {
+  sleepEnabled = true;
+}
+
+void sleep_disable() {
+  sleepEnabled = false;
+}
+
+void sleep_cpu() {
+  if (!sleepEnabled) return;
+
+  unsigned long long now = HostSim::nowUs();
+  unsigned long long watchdogDue = watchdogDueUs();
+
+  if (sleepMode == SLEEP_MODE_IDLE) {
+    // Timer0 runs: the next millisecond tick wakes the CPU at the latest
+    unsigned long long tick = now + HostSim::usUntilMillisTick();
+    if (watchdogDue <= tick) {
+      HostSim::advanceUs(watchdogDue > now ? watchdogDue - now : 0);
+      if (SREG & _BV(SREG_I)) watchdogTimeout();
+    } else {
+      HostSim::advanceUs(tick - now);
+    }
+    return;
+  }
+
+  // Power-down: only the watchdog or an external interrupt wakes the CPU
+  powerDowns++;
+  if (!(SREG & _BV(SREG_I)) || (watchdogDue == NEVER && nextExternalUs == NEVER)) {
+    std::fprintf(stderr, "AvrSim: power-down without a wake-up source\n");
+    watchdogResets++;
+    return;
+  }
+  if (nextExternalUs != NEVER && nextExternalUs < now) {
+    scheduleExternal(now);
+  }
+
+  bool external = nextExternalUs < watchdogDue;
+  unsigned long long wakeUs = external ? nextExternalUs : watchdogDue;
+  HostSim::advanceAsleepUs(wakeUs - now + STARTUP_US);  // Timer0 stopped throughout
+
+  if (external) {
+    externalWakes++;
+    scheduleExternal(wakeUs);
+  }
+  // The watchdog may also have timed out during the oscillator start-up
+  if (watchdogDueUs() <= HostSim::nowUs()) {
+    watchdogTimeout();
+  }
+}
+
+namespace AvrSim {
+  void reset() {
+    SREG = _BV(SREG_I);
+    WDTCSR = 0;
+    MCUSR = 0;
+    ADCSRA = _BV(ADEN);
+    sleepMode = SLEEP_MODE_IDLE;
+    sleepEnabled = false;
+    watchdogScale = 1.0;
+    watchdogStartUs = HostSim::nowUs();
+    externalMeanUs = 0;
+    nextExternalUs = NEVER;
+    powerDowns = 0;
+    externalWakes = 0;
+    watchdogResets = 0;
+  }
+
+  void setWatchdogScale(double scale) {
+    watchdogScale = scale;
+  }
+
+  void setExternalInterrupts(unsigned long long meanUs, unsigned int seed) {
+    externalMeanUs = meanUs;
+    rng.seed(seed);
+    scheduleExternal(HostSim::nowUs());
+  }
+
+  unsigned long getPowerDowns() { return powerDowns; }
+  unsigned long getExternalWakes() { return externalWakes; }
+  unsigned long getWatchdogResets() { return watchdogResets; }
+}
@@ -0,0 +1,33 @@
+/*
+ * AvrSim.h (host stub)
+ *
+ * Controls for the ATmega328P watchdog and sleep emulation used when a
+ * test is built with -D__AVR__ (see AvrSim.cpp).
+ *
+ * The watchdog runs from its own oscillator: the nominal shortest period
+ * is 2048 cycles at 128 kHz (16 ms), and the real one is off by up to
+ * +/-10% with supply voltage and temperature. setWatchdogScale() sets
+ * that error. Waking from power-down takes 16K CPU cycles of oscillator
+ * start-up, during which Timer0 (millis) does not run.
+ */
+
+#ifndef HOST_AVRSIM_H
+#define HOST_AVRSIM_H
+
+namespace AvrSim {
+  void reset();
+
+  // Watchdog period multiplier: 1.10 = oscillator 10% slow (longer periods)
+  void setWatchdogScale(double scale);
+
+  // Random external interrupts (e.g. a pin change) during power-down,
+  // meanUs apart on average; 0 disables them
+  void setExternalInterrupts(unsigned long long meanUs, unsigned int seed);
+
+  // Statistics
+  unsigned long getPowerDowns();       // Entries into power-down sleep
+  unsigned long getExternalWakes();    // Power-downs ended by an external interrupt
+  unsigned long getWatchdogResets();   // Watchdog timeouts that would reset the chip
+}
+
+#endif
@@ -0,0 +1,37 @@
+/*
+ * Servo.h (host stub)
+ *
+ * Records the attached pin and the last angle written, and counts the
+ * servos attached at the moment (Servo::attachedCount()).
+ */
+
+#ifndef HOST_SERVO_H
+#define HOST_SERVO_H
+
+class Servo {
+  private:
+    int pin;
+    int angle;
+
+  public:
+    Servo() : pin(-1), angle(90) {}
+    ~Servo() { detach(); }
+    void attach(int servoPin) {
+      if (pin < 0) attachedCount()++;
+      pin = servoPin;
+    }
+    void detach() {
+      if (pin >= 0) attachedCount()--;
+      pin = -1;
+    }
+    bool attached() { return pin >= 0; }
+    void write(int value) { angle = value; }
+    int read() { return angle; }
+
+    static int& attachedCount() {
+      static int count = 0;
+      return count;
+    }
+};
+
+#endif
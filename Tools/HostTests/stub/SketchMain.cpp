@@ -0,0 +1,26 @@
+/*
+ * SketchMain.cpp (host stub)
+ *
+ * main() for running a whole sketch (.ino) on the host: setup(), then
+ * loop() SKETCH_LOOPS times. Sketches poll micros() in busy loops like
+ * on the board, so the clock is the wall clock here.
+ * The exit code is 1 if the sketch printed "FAILED" to Serial.
+ */
+
+#include "Arduino.h"
+
+#ifndef SKETCH_LOOPS
+#define SKETCH_LOOPS 1
+#endif
+
+void setup();
+void loop();
+
+int main() {
+  HostSim::useRealTime(true);
+  setup();
+  for (long i = 0; i < SKETCH_LOOPS; i++) {
+    loop();
+  }
+  return HostSim::serialOutput().find("FAILED") == std::string::npos ? 0 : 1;
+}
@@ -0,0 +1,24 @@
+/*
+ * SoftwareSerial.h (host stub)
+ *
+ * A serial port with nothing connected: writes are dropped and nothing
+ * is ever received. Enough to build and start sketches that use one.
+ */
+
+#ifndef HOST_SOFTWARESERIAL_H
+#define HOST_SOFTWARESERIAL_H
+
+#include "Arduino.h"
+
+class SoftwareSerial : public Stream {
+  public:
+    SoftwareSerial(int rxPin, int txPin) { (void)rxPin; (void)txPin; }
+    void begin(unsigned long baud) { (void)baud; }
+    size_t write(uint8_t b) override { (void)b; return 1; }
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+};
+
+#endif
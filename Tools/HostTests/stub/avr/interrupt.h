@@ -0,0 +1,22 @@
+/*
+ * avr/interrupt.h (host stub)
+ *
+ * cli()/sei() change the emulated SREG. ISR(vector) defines a plain
+ * function that AvrSim.cpp calls when the emulated interrupt fires.
+ */
+
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+#include <avr/io.h>
+
+inline void cli() { SREG &= (uint8_t)~_BV(SREG_I); }
+inline void sei() { SREG |= (uint8_t)_BV(SREG_I); }
+
+#define WDT_vect hostWatchdogVector
+
+#define ISR(vector, ...) \
+  extern "C" void vector(void) __VA_ARGS__; \
+  extern "C" void vector(void)
+
+#endif
@@ -0,0 +1,44 @@
+/*
+ * avr/io.h (host stub)
+ *
+ * The ATmega328P registers used by the sketches, as plain variables.
+ * Only included when a test is built with -D__AVR__ to run the real AVR
+ * code paths against the emulation in AvrSim.cpp.
+ */
+
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+#include <stdint.h>
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+#define _BV(bit) (1 << (bit))
+
+extern volatile uint8_t SREG;
+extern volatile uint8_t WDTCSR;
+extern volatile uint8_t MCUSR;
+extern volatile uint8_t ADCSRA;
+
+// SREG
+#define SREG_I 7
+
+// WDTCSR
+#define WDIF 7
+#define WDIE 6
+#define WDP3 5
+#define WDCE 4
+#define WDE 3
+#define WDP2 2
+#define WDP1 1
+#define WDP0 0
+
+// MCUSR
+#define WDRF 3
+
+// ADCSRA
+#define ADEN 7
+
+#endif
@@ -0,0 +1,27 @@
+/*
+ * avr/sleep.h (host stub)
+ *
+ * Sleeping advances the simulated clock until the next wake-up source
+ * fires (see AvrSim.cpp).
+ */
+
+#ifndef HOST_AVR_SLEEP_H
+#define HOST_AVR_SLEEP_H
+
+#include <avr/io.h>
+
+#define SLEEP_MODE_IDLE 0
+#define SLEEP_MODE_PWR_DOWN 2
+
+void set_sleep_mode(uint8_t mode);
+void sleep_enable();
+void sleep_disable();
+void sleep_cpu();
+
+inline void sleep_mode() {
+  sleep_enable();
+  sleep_cpu();
+  sleep_disable();
+}
+
+#endif
@@ -0,0 +1,597 @@
+/*
+ * Telemetry.cpp
+ *
+ * Implementation of capture parsing and statistics.
+ * Parsing and analysis split the work into contiguous ranges, one per
+ * thread, and merge the partial results afterwards. The moment kernels
+ * use AVX2 when the compiler targets it (-march=native) and fall back to
+ * plain loops, which the compiler can still auto-vectorize.
+ */
+
+#include "Telemetry.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace telemetry {
+
+// ---------------------------------------------------------------------------
+// Columns and file mapping
+// ---------------------------------------------------------------------------
+
+const char* channelName(int channel) {
+  static const char* const names[CHANNEL_COUNT] = {"Temp", "Light", "PWM", "Stored", "Input"};
+  return (channel >= 0 && channel < CHANNEL_COUNT) ? names[channel] : "?";
+}
+
+void Columns::reserve(size_t n) {
+  for (auto& column : data) column.reserve(n);
+}
+
+void Columns::append(const Columns& other) {
+  for (int c = 0; c < CHANNEL_COUNT; c++) {
+    data[c].insert(data[c].end(), other.data[c].begin(), other.data[c].end());
+  }
+}
+
+MappedFile::MappedFile(const std::string& path) : bytes(nullptr), length(0) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("cannot open " + path);
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    close(fd);
+    throw std::runtime_error("cannot stat " + path);
+  }
+
+  length = static_cast<size_t>(info.st_size);
+  if (length > 0) {
+    void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+      close(fd);
+      throw std::runtime_error("cannot mmap " + path);
+    }
+    madvise(mapped, length, MADV_SEQUENTIAL);  // Read-ahead for streaming parse
+    bytes = static_cast<const char*>(mapped);
+  }
+  close(fd);  // The mapping stays valid after closing
+}
+
+MappedFile::~MappedFile() {
+  if (bytes != nullptr) {
+    munmap(const_cast<char*>(bytes), length);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Parallel helpers
+// ---------------------------------------------------------------------------
+
+static unsigned clampThreads(unsigned threads, size_t work) {
+  if (threads == 0) threads = 1;
+  if (work < threads) threads = work == 0 ? 1 : static_cast<unsigned>(work);
+  return threads;
+}
+
+// Run fn(threadIndex, begin, end) over [0, n) split into equal ranges
+template <typename Fn>
+static void parallelFor(size_t n, unsigned threads, Fn fn) {
+  threads = clampThreads(threads, n);
+  std::vector<std::thread> pool;
+  for (unsigned t = 1; t < threads; t++) {
+    pool.emplace_back(fn, t, n * t / threads, n * (t + 1) / threads);
+  }
+  fn(0u, size_t(0), n / threads);
+  for (auto& worker : pool) worker.join();
+}
+
+// ---------------------------------------------------------------------------
+// Parsing
+// ---------------------------------------------------------------------------
+
+bool isBinaryCapture(const char* data, size_t size) {
+  return size >= BINARY_HEADER_SIZE && std::memcmp(data, BINARY_MAGIC, 4) == 0;
+}
+
+// The sketch prints Arduino ints (16-bit on the Uno), as the binary format
+// stores them. Bounding the values keeps every later sum free of overflow.
+static const int32_t FIELD_MAX = INT16_MAX;
+
+// The labels in the order the sketch prints them
+static const char* const FIELD_LABELS[4] = {"Temp:", "Light:", "PWM:", "Stored:"};
+
+static bool isBlank(char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Parse "Temp:<n>  Light:<n>  PWM:<n>  Stored:<n>" (Serial.println() ends it
+// with "\r\n"); false for any other line, including one with a value outside
+// the 16-bit range, a wrong label or anything after the last value
+static bool parseLine(const char* p, const char* end, int32_t fields[4]) {
+  for (int field = 0; field < 4; field++) {
+    if (field > 0) {
+      if (p == end || !isBlank(*p)) return false;  // Values need a separator
+      while (p < end && isBlank(*p)) ++p;
+    }
+    size_t labelLength = std::strlen(FIELD_LABELS[field]);
+    if (static_cast<size_t>(end - p) < labelLength ||
+        std::memcmp(p, FIELD_LABELS[field], labelLength) != 0) {
+      return false;
+    }
+    p += labelLength;
+
+    bool negative = false;
+    if (p < end && *p == '-') {
+      negative = true;
+      ++p;
+    }
+    if (p == end || *p < '0' || *p > '9') return false;
+
+    int32_t value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+      value = value * 10 + (*p - '0');
+      if (value > FIELD_MAX + 1) return false;  // Stops before value * 10 can overflow
+      ++p;
+    }
+    if (!negative && value > FIELD_MAX) return false;
+    fields[field] = negative ? -value : value;
+  }
+
+  while (p < end && isBlank(*p)) ++p;
+  return p == end;
+}
+
+// Fields are 16-bit values, so (temp + light) cannot overflow
+static void appendSample(Columns& out, int32_t temp, int32_t light, int32_t pwm, int32_t stored) {
+  out.data[TEMP].push_back(temp);
+  out.data[LIGHT].push_back(light);
+  out.data[PWM].push_back(pwm);
+  out.data[STORED].push_back(stored);
+  out.data[INPUT].push_back((temp + light) / 2);
+}
+
+static void parseTextRange(const char* begin, const char* end, Columns& out) {
+  out.reserve(static_cast<size_t>(end - begin) / 40);  // ~40 bytes per line
+
+  const char* line = begin;
+  int32_t fields[4];
+  while (line < end) {
+    const char* newline = static_cast<const char*>(std::memchr(line, '\n', end - line));
+    const char* lineEnd = newline ? newline : end;
+    if (parseLine(line, lineEnd, fields)) {
+      appendSample(out, fields[0], fields[1], fields[2], fields[3]);
+    }
+    line = lineEnd + 1;
+  }
+}
+
+static Columns parseText(const char* data, size_t size, unsigned threads) {
+  // Cut the file into roughly equal ranges that start at a line boundary
+  threads = clampThreads(threads, size / 4096 + 1);
+  std::vector<const char*> cuts(threads + 1);
+  cuts[0] = data;
+  cuts[threads] = data + size;
+  for (unsigned t = 1; t < threads; t++) {
+    const char* guess = std::max(data + size * t / threads, cuts[t - 1]);
+    const char* newline = static_cast<const char*>(std::memchr(guess, '\n', data + size - guess));
+    cuts[t] = newline ? newline + 1 : data + size;
+  }
+
+  std::vector<Columns> parts(threads);
+  std::vector<std::thread> pool;
+  for (unsigned t = 1; t < threads; t++) {
+    pool.emplace_back(parseTextRange, cuts[t], cuts[t + 1], std::ref(parts[t]));
+  }
+  parseTextRange(cuts[0], cuts[1], parts[0]);
+  for (auto& worker : pool) worker.join();
+
+  // Keep the first part's buffers and append the rest in file order
+  Columns result = std::move(parts[0]);
+  size_t total = 0;
+  for (const auto& part : parts) total += part.size();
+  result.reserve(total);
+  for (unsigned t = 1; t < threads; t++) result.append(parts[t]);
+  return result;
+}
+
+static int16_t readInt16(const char* p) {
+  uint16_t raw = static_cast<uint16_t>(static_cast<uint8_t>(p[0]) | (static_cast<uint8_t>(p[1]) << 8));
+  return static_cast<int16_t>(raw);
+}
+
+static Columns parseBinary(const char* data, size_t size, unsigned threads) {
+  uint16_t version = static_cast<uint16_t>(readInt16(data + 4));
+  uint16_t channels = static_cast<uint16_t>(readInt16(data + 6));
+  if (version != BINARY_VERSION || channels < 4) {
+    throw std::runtime_error("unsupported binary capture (version or channel count)");
+  }
+
+  uint64_t declared = 0;
+  for (int i = 7; i >= 0; i--) {
+    declared = (declared << 8) | static_cast<uint8_t>(data[8 + i]);
+  }
+
+  size_t recordSize = static_cast<size_t>(channels) * 2;
+  size_t available = (size - BINARY_HEADER_SIZE) / recordSize;
+  size_t records = (declared == 0 || declared > available) ? available : static_cast<size_t>(declared);
+
+  Columns result;
+  for (auto& column : result.data) column.resize(records);
+
+  const char* base = data + BINARY_HEADER_SIZE;
+  parallelFor(records, threads, [&](unsigned, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      const char* record = base + i * recordSize;
+      int32_t temp = readInt16(record);
+      int32_t light = readInt16(record + 2);
+      result.data[TEMP][i] = temp;
+      result.data[LIGHT][i] = light;
+      result.data[PWM][i] = readInt16(record + 4);
+      result.data[STORED][i] = readInt16(record + 6);
+      result.data[INPUT][i] = (temp + light) / 2;
+    }
+  });
+  return result;
+}
+
+Columns parseCapture(const char* data, size_t size, unsigned threads) {
+  if (isBinaryCapture(data, size)) {
+    return parseBinary(data, size, threads);
+  }
+  return parseText(data, size, threads);
+}
+
+// ---------------------------------------------------------------------------
+// SIMD kernels
+// ---------------------------------------------------------------------------
+
+struct Moments {
+  int32_t min = INT32_MAX;
+  int32_t max = INT32_MIN;
+  int64_t sum = 0;
+  int64_t sumSquares = 0;
+};
+
+// Min, max, sum and sum of squares in one pass (exact 64-bit sums)
+static Moments computeMoments(const int32_t* v, size_t n) {
+  Moments m;
+  size_t i = 0;
+
+#if defined(__AVX2__)
+  __m256i vmin = _mm256_set1_epi32(INT32_MAX);
+  __m256i vmax = _mm256_set1_epi32(INT32_MIN);
+  __m256i vsum = _mm256_setzero_si256();
+  __m256i vsq = _mm256_setzero_si256();
+  for (; i + 8 <= n; i += 8) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i));
+    vmin = _mm256_min_epi32(vmin, x);
+    vmax = _mm256_max_epi32(vmax, x);
+
+    // Widen to 64-bit lanes so sums and squares cannot overflow
+    __m256i lo = _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x));
+    __m256i hi = _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1));
+    vsum = _mm256_add_epi64(vsum, _mm256_add_epi64(lo, hi));
+    vsq = _mm256_add_epi64(vsq, _mm256_add_epi64(_mm256_mul_epi32(lo, lo), _mm256_mul_epi32(hi, hi)));
+  }
+
+  alignas(32) int32_t mins[8], maxs[8];
+  alignas(32) int64_t sums[4], squares[4];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(mins), vmin);
+  _mm256_store_si256(reinterpret_cast<__m256i*>(maxs), vmax);
+  _mm256_store_si256(reinterpret_cast<__m256i*>(sums), vsum);
+  _mm256_store_si256(reinterpret_cast<__m256i*>(squares), vsq);
+  for (int lane = 0; lane < 8; lane++) {
+    m.min = std::min(m.min, mins[lane]);
+    m.max = std::max(m.max, maxs[lane]);
+  }
+  for (int lane = 0; lane < 4; lane++) {
+    m.sum += sums[lane];
+    m.sumSquares += squares[lane];
+  }
+#endif
+
+  for (; i < n; i++) {
+    int64_t x = v[i];
+    m.min = std::min(m.min, v[i]);
+    m.max = std::max(m.max, v[i]);
+    m.sum += x;
+    m.sumSquares += x * x;
+  }
+  return m;
+}
+
+// Sum of x[i] * y[i] (exact 64-bit)
+static int64_t crossSum(const int32_t* x, const int32_t* y, size_t n) {
+  int64_t total = 0;
+  size_t i = 0;
+
+#if defined(__AVX2__)
+  __m256i acc = _mm256_setzero_si256();
+  for (; i + 4 <= n; i += 4) {
+    __m256i a = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i)));
+    __m256i b = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i)));
+    acc = _mm256_add_epi64(acc, _mm256_mul_epi32(a, b));
+  }
+  alignas(32) int64_t lanes[4];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+  total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+
+  for (; i < n; i++) {
+    total += static_cast<int64_t>(x[i]) * y[i];
+  }
+  return total;
+}
+
+// Runs of identical samples; mergeable across ranges
+struct Runs {
+  size_t length = 0;   // Samples covered
+  int32_t first = 0;
+  int32_t last = 0;
+  size_t prefix = 0;   // Run length starting at the first sample
+  size_t suffix = 0;   // Run length ending at the last sample
+  size_t longest = 0;
+  int32_t longestValue = 0;
+};
+
+static Runs computeRuns(const int32_t* v, size_t n) {
+  Runs r;
+  if (n == 0) return r;
+
+  r.length = n;
+  r.first = v[0];
+  r.last = v[n - 1];
+
+  size_t current = 1;
+  r.longest = 1;
+  r.longestValue = v[0];
+  r.prefix = 0;
+  for (size_t i = 1; i < n; i++) {
+    if (v[i] == v[i - 1]) {
+      current++;
+    } else {
+      if (r.prefix == 0) r.prefix = current;
+      current = 1;
+    }
+    if (current > r.longest) {
+      r.longest = current;
+      r.longestValue = v[i];
+    }
+  }
+  if (r.prefix == 0) r.prefix = n;  // The whole range is one run
+  r.suffix = current;
+  return r;
+}
+
+static Runs mergeRuns(const Runs& a, const Runs& b) {
+  if (a.length == 0) return b;
+  if (b.length == 0) return a;
+
+  Runs r;
+  bool joined = a.last == b.first;
+  r.length = a.length + b.length;
+  r.first = a.first;
+  r.last = b.last;
+  r.prefix = (joined && a.prefix == a.length) ? a.length + b.prefix : a.prefix;
+  r.suffix = (joined && b.suffix == b.length) ? b.length + a.suffix : b.suffix;
+
+  r.longest = a.longest;
+  r.longestValue = a.longestValue;
+  if (b.longest > r.longest) {
+    r.longest = b.longest;
+    r.longestValue = b.longestValue;
+  }
+  if (joined && a.suffix + b.prefix > r.longest) {
+    r.longest = a.suffix + b.prefix;
+    r.longestValue = a.last;
+  }
+  return r;
+}
+
+// Equal-width histogram over [lo, hi]; a lookup table avoids a division per sample
+static void accumulateHistogram(const int32_t* v, size_t n, int32_t lo, int32_t hi,
+                                std::vector<uint64_t>& bins) {
+  int64_t range = static_cast<int64_t>(hi) - lo + 1;
+  int64_t binCount = static_cast<int64_t>(bins.size());
+
+  if (range <= 65536) {
+    std::vector<uint32_t> lookup(static_cast<size_t>(range));
+    for (int64_t offset = 0; offset < range; offset++) {
+      lookup[offset] = static_cast<uint32_t>(offset * binCount / range);
+    }
+    for (size_t i = 0; i < n; i++) {
+      bins[lookup[v[i] - lo]]++;
+    }
+  } else {
+    for (size_t i = 0; i < n; i++) {
+      bins[(static_cast<int64_t>(v[i]) - lo) * binCount / range]++;
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Analysis
+// ---------------------------------------------------------------------------
+
+double ChannelStats::mean() const {
+  return count ? static_cast<double>(sum) / count : 0.0;
+}
+
+double ChannelStats::variance() const {
+  if (count == 0) return 0.0;
+  long double n = count;
+  long double m = static_cast<long double>(sum) / n;
+  return static_cast<double>(static_cast<long double>(sumSquares) / n - m * m);
+}
+
+static double pearson(size_t count, const ChannelStats& x, const ChannelStats& y, int64_t sumXY) {
+  if (count < 2) return 0.0;
+  long double n = count;
+  long double covariance = n * sumXY - static_cast<long double>(x.sum) * y.sum;
+  long double varX = n * x.sumSquares - static_cast<long double>(x.sum) * x.sum;
+  long double varY = n * y.sumSquares - static_cast<long double>(y.sum) * y.sum;
+  if (varX <= 0 || varY <= 0) return 0.0;  // A constant channel has no correlation
+  return static_cast<double>(covariance / std::sqrt(varX * varY));
+}
+
+Report analyze(const Columns& columns, unsigned threads, int histogramBins) {
+  size_t n = columns.size();
+  threads = clampThreads(threads, n);
+  if (histogramBins < 1) histogramBins = 1;
+
+  // Pass 1: moments, runs and cross sums per range
+  struct Partial {
+    std::array<Moments, CHANNEL_COUNT> moments;
+    std::array<Runs, CHANNEL_COUNT> runs;
+    int64_t pwmInput = 0;
+    int64_t pwmTemp = 0;
+    int64_t pwmLight = 0;
+  };
+  std::vector<Partial> partials(threads);
+
+  parallelFor(n, threads, [&](unsigned t, size_t begin, size_t end) {
+    Partial& p = partials[t];
+    size_t count = end - begin;
+    for (int c = 0; c < CHANNEL_COUNT; c++) {
+      const int32_t* v = columns.data[c].data() + begin;
+      p.moments[c] = computeMoments(v, count);
+      p.runs[c] = computeRuns(v, count);
+    }
+    const int32_t* pwm = columns.data[PWM].data() + begin;
+    p.pwmInput = crossSum(pwm, columns.data[INPUT].data() + begin, count);
+    p.pwmTemp = crossSum(pwm, columns.data[TEMP].data() + begin, count);
+    p.pwmLight = crossSum(pwm, columns.data[LIGHT].data() + begin, count);
+  });
+
+  Report report;
+  int64_t pwmInput = 0, pwmTemp = 0, pwmLight = 0;
+  for (int c = 0; c < CHANNEL_COUNT; c++) {
+    ChannelStats& s = report.channels[c];
+    s.count = n;
+    Moments total;
+    Runs runs;
+    for (const Partial& p : partials) {  // Partials are in file order
+      total.min = std::min(total.min, p.moments[c].min);
+      total.max = std::max(total.max, p.moments[c].max);
+      total.sum += p.moments[c].sum;
+      total.sumSquares += p.moments[c].sumSquares;
+      runs = mergeRuns(runs, p.runs[c]);
+    }
+    s.min = n ? total.min : 0;
+    s.max = n ? total.max : 0;
+    s.sum = total.sum;
+    s.sumSquares = total.sumSquares;
+    s.longestRun = runs.longest;
+    s.longestRunValue = runs.longestValue;
+    s.histogram.assign(static_cast<size_t>(histogramBins), 0);
+  }
+  for (const Partial& p : partials) {
+    pwmInput += p.pwmInput;
+    pwmTemp += p.pwmTemp;
+    pwmLight += p.pwmLight;
+  }
+
+  report.pwmVsInput = pearson(n, report.channels[PWM], report.channels[INPUT], pwmInput);
+  report.pwmVsTemp = pearson(n, report.channels[PWM], report.channels[TEMP], pwmTemp);
+  report.pwmVsLight = pearson(n, report.channels[PWM], report.channels[LIGHT], pwmLight);
+
+  // Pass 2: histograms over the global [min, max] of each channel
+  if (n > 0) {
+    std::vector<std::array<std::vector<uint64_t>, CHANNEL_COUNT>> bins(threads);
+    parallelFor(n, threads, [&](unsigned t, size_t begin, size_t end) {
+      for (int c = 0; c < CHANNEL_COUNT; c++) {
+        const ChannelStats& s = report.channels[c];
+        bins[t][c].assign(static_cast<size_t>(histogramBins), 0);
+        accumulateHistogram(columns.data[c].data() + begin, end - begin, s.min, s.max, bins[t][c]);
+      }
+    });
+    for (int c = 0; c < CHANNEL_COUNT; c++) {
+      for (unsigned t = 0; t < threads; t++) {
+        for (int b = 0; b < histogramBins; b++) {
+          report.channels[c].histogram[b] += bins[t][c][b];
+        }
+      }
+    }
+  }
+
+  return report;
+}
+
+// ---------------------------------------------------------------------------
+// Synthetic captures
+// ---------------------------------------------------------------------------
+
+void generateCapture(const std::string& path, size_t targetBytes, bool binary) {
+  FILE* out = std::fopen(path.c_str(), "wb");
+  if (out == nullptr) {
+    throw std::runtime_error("cannot create " + path);
+  }
+
+  uint32_t seed = 12345;
+  auto next = [&seed]() {
+    seed = seed * 1664525u + 1013904223u;  // Small LCG: reproducible output
+    return seed >> 16;
+  };
+
+  std::string buffer;
+  buffer.reserve(1 << 20);
+  size_t written = 0;
+
+  if (binary) {
+    char header[BINARY_HEADER_SIZE] = {'O', 'O', 'T', 'L', 1, 0, 4, 0};  // Count 0: use file size
+    buffer.append(header, sizeof(header));
+  } else {
+    buffer += "Stage 4 - Refactored Build\n\n";
+  }
+
+  int32_t temp = 512, light = 512;
+  for (size_t sample = 0; written + buffer.size() < targetBytes; sample++) {
+    temp = std::min(1023, std::max(0, temp + static_cast<int32_t>(next() % 9) - 4));
+    // Every 100k samples the light sensor freezes for 500 samples
+    if (sample % 100000 >= 500) {
+      light = std::min(1023, std::max(0, light + static_cast<int32_t>(next() % 41) - 20));
+    }
+    int32_t pwm = ((temp + light) / 2) * 255 / 1023;
+
+    if (binary) {
+      int16_t record[4] = {static_cast<int16_t>(temp), static_cast<int16_t>(light),
+                           static_cast<int16_t>(pwm), static_cast<int16_t>(pwm)};
+      for (int16_t value : record) {
+        buffer.push_back(static_cast<char>(value & 0xFF));
+        buffer.push_back(static_cast<char>((value >> 8) & 0xFF));
+      }
+    } else {
+      char line[64];
+      int len = std::snprintf(line, sizeof(line), "Temp:%d  Light:%d  PWM:%d  Stored:%d\n",
+                              temp, light, pwm, pwm);
+      buffer.append(line, static_cast<size_t>(len));
+    }
+
+    if (buffer.size() >= (1 << 20)) {
+      std::fwrite(buffer.data(), 1, buffer.size(), out);
+      written += buffer.size();
+      buffer.clear();
+    }
+  }
+
+  std::fwrite(buffer.data(), 1, buffer.size(), out);
+  std::fclose(out);
+}
+
+}  // namespace telemetry
@@ -0,0 +1,104 @@
+/*
+ * Telemetry.h
+ *
+ * Host-side parsing and statistics for telemetry captured from the boards.
+ *
+ * Supported capture formats:
+ * - Text: the Serial lines printed by Stage4_Refactored.ino
+ *     Temp:512  Light:300  PWM:103  Stored:103
+ *   Values must fit an Arduino int (-32768..32767). Any other line
+ *   (banners, error messages, out-of-range values) is skipped.
+ * - Binary: a 16-byte header followed by fixed-size records
+ *     offset 0  char[4]  magic "OOTL"
+ *     offset 4  uint16   version (1)
+ *     offset 6  uint16   channels per record (4: temp, light, pwm, stored)
+ *     offset 8  uint64   record count (0 = use the file size)
+ *     records   int16[channels], little-endian
+ *
+ * Samples are stored column by column (one array per channel) so the
+ * statistics kernels can stream through contiguous memory with SIMD.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace telemetry {
+
+// Channel order matches the text line; INPUT is derived as (temp + light) / 2,
+// the same value Stage 4 maps to PWM
+enum Channel { TEMP, LIGHT, PWM, STORED, INPUT, CHANNEL_COUNT };
+
+const char* channelName(int channel);
+
+// Columnar sample buffers, one vector per channel
+struct Columns {
+  std::array<std::vector<int32_t>, CHANNEL_COUNT> data;
+
+  size_t size() const { return data[TEMP].size(); }
+  void reserve(size_t n);
+  void append(const Columns& other);
+};
+
+// Read-only memory mapping of a capture file (POSIX mmap)
+class MappedFile {
+  private:
+    const char* bytes;
+    size_t length;
+
+  public:
+    explicit MappedFile(const std::string& path);  // Throws std::runtime_error
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+};
+
+// Binary capture header layout
+const char BINARY_MAGIC[4] = {'O', 'O', 'T', 'L'};
+const size_t BINARY_HEADER_SIZE = 16;
+const uint16_t BINARY_VERSION = 1;
+
+bool isBinaryCapture(const char* data, size_t size);
+
+// Parse a whole capture (text or binary) using up to `threads` cores
+Columns parseCapture(const char* data, size_t size, unsigned threads);
+
+// Per-channel statistics
+struct ChannelStats {
+  size_t count = 0;
+  int32_t min = 0;
+  int32_t max = 0;
+  int64_t sum = 0;
+  int64_t sumSquares = 0;
+  std::vector<uint64_t> histogram;  // Equal-width bins over [min, max]
+  size_t longestRun = 0;            // Longest run of identical samples
+  int32_t longestRunValue = 0;
+
+  double mean() const;
+  double variance() const;          // Population variance
+};
+
+struct Report {
+  std::array<ChannelStats, CHANNEL_COUNT> channels;
+  double pwmVsInput = 0.0;  // Pearson correlation coefficients
+  double pwmVsTemp = 0.0;
+  double pwmVsLight = 0.0;
+};
+
+// Compute statistics over the columns using up to `threads` cores
+Report analyze(const Columns& columns, unsigned threads, int histogramBins);
+
+// Write a synthetic capture (used for benchmarks and demos)
+void generateCapture(const std::string& path, size_t targetBytes, bool binary);
+
+}  // namespace telemetry
+
+#endif
@@ -0,0 +1,159 @@
+/*
+ * TelemetryAnalyzer.cpp
+ *
+ * Command-line tool: memory-maps capture files, parses them in parallel
+ * and prints per-channel statistics, histograms, PWM-vs-input correlation
+ * and stuck-sensor warnings. With --bench it repeats the work and reports
+ * parse and analysis throughput in GB/s.
+ *
+ * Usage:
+ *   TelemetryAnalyzer [--threads N] [--bins N] [--stuck N] [--bench N] capture...
+ *   TelemetryAnalyzer --generate FILE MEGABYTES [--binary]
+ */
+
+#include "Telemetry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace telemetry;
+
+namespace {
+
+struct Options {
+  unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+  int bins = 16;
+  size_t stuckRun = 200;  // Identical sensor samples in a row before warning
+  int benchRuns = 0;
+  std::vector<std::string> files;
+};
+
+void printUsage() {
+  std::puts("Usage:");
+  std::puts("  TelemetryAnalyzer [--threads N] [--bins N] [--stuck N] [--bench N] capture...");
+  std::puts("  TelemetryAnalyzer --generate FILE MEGABYTES [--binary]");
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void printReport(const std::string& path, const Report& report, const Options& options) {
+  size_t samples = report.channels[TEMP].count;
+  std::printf("== %s: %zu samples\n", path.c_str(), samples);
+  if (samples == 0) return;
+
+  std::printf("%-7s %8s %8s %10s %12s %10s\n", "Channel", "Min", "Max", "Mean", "Variance", "LongestRun");
+  for (int c = 0; c < CHANNEL_COUNT; c++) {
+    const ChannelStats& s = report.channels[c];
+    std::printf("%-7s %8d %8d %10.2f %12.2f %10zu\n", channelName(c), s.min, s.max, s.mean(),
+                s.variance(), s.longestRun);
+  }
+
+  std::puts("\nHistograms (equal-width bins over [min, max]):");
+  for (int c = 0; c < CHANNEL_COUNT; c++) {
+    std::printf("%-7s", channelName(c));
+    for (uint64_t count : report.channels[c].histogram) {
+      std::printf(" %llu", static_cast<unsigned long long>(count));
+    }
+    std::puts("");
+  }
+
+  std::printf("\nCorrelation PWM vs Input: %+.4f  (vs Temp %+.4f, vs Light %+.4f)\n",
+              report.pwmVsInput, report.pwmVsTemp, report.pwmVsLight);
+
+  // Only the sensor channels can be "stuck"; a steady PWM is a valid output
+  for (int c : {TEMP, LIGHT}) {
+    const ChannelStats& s = report.channels[c];
+    if (s.longestRun >= options.stuckRun) {
+      std::printf("WARNING: %s sensor possibly stuck - %zu identical samples (value %d)\n",
+                  channelName(c), s.longestRun, s.longestRunValue);
+    }
+  }
+  std::puts("");
+}
+
+void benchmark(const MappedFile& file, const Options& options) {
+  double bestParse = 1e30, bestAnalyze = 1e30;
+  size_t samples = 0;
+  for (int run = 0; run < options.benchRuns; run++) {
+    auto start = std::chrono::steady_clock::now();
+    Columns columns = parseCapture(file.data(), file.size(), options.threads);
+    bestParse = std::min(bestParse, secondsSince(start));
+
+    start = std::chrono::steady_clock::now();
+    Report report = analyze(columns, options.threads, options.bins);
+    bestAnalyze = std::min(bestAnalyze, secondsSince(start));
+    samples = report.channels[TEMP].count;
+  }
+
+  double gb = file.size() / 1e9;
+  double columnGb = samples * CHANNEL_COUNT * sizeof(int32_t) / 1e9;
+  std::printf("Benchmark (best of %d, %u threads):\n", options.benchRuns, options.threads);
+  std::printf("  parse:   %.3f s  %.2f GB/s of capture\n", bestParse, gb / bestParse);
+  std::printf("  analyse: %.3f s  %.2f GB/s of capture, %.2f GB/s of columns\n", bestAnalyze,
+              gb / bestAnalyze, columnGb / bestAnalyze);
+  std::printf("  total:   %.2f GB/s of capture\n\n", gb / (bestParse + bestAnalyze));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+
+  try {
+    for (int i = 1; i < argc; i++) {
+      std::string arg = argv[i];
+      bool hasValue = i + 1 < argc;
+      if (arg == "--generate" && i + 2 < argc) {
+        std::string path = argv[i + 1];
+        size_t megabytes = std::strtoull(argv[i + 2], nullptr, 10);
+        bool binary = i + 3 < argc && std::strcmp(argv[i + 3], "--binary") == 0;
+        generateCapture(path, megabytes << 20, binary);
+        std::printf("Wrote %zu MB %s capture to %s\n", megabytes, binary ? "binary" : "text", path.c_str());
+        return 0;
+      } else if (arg == "--threads" && hasValue) {
+        options.threads = std::max(1, std::atoi(argv[++i]));
+      } else if (arg == "--bins" && hasValue) {
+        options.bins = std::max(1, std::atoi(argv[++i]));
+      } else if (arg == "--stuck" && hasValue) {
+        options.stuckRun = std::strtoull(argv[++i], nullptr, 10);
+      } else if (arg == "--bench" && hasValue) {
+        options.benchRuns = std::max(1, std::atoi(argv[++i]));
+      } else if (arg == "--help" || arg == "-h") {
+        printUsage();
+        return 0;
+      } else if (arg.rfind("--", 0) == 0) {
+        printUsage();  // Unknown option or missing value
+        return 1;
+      } else {
+        options.files.push_back(arg);
+      }
+    }
+
+    if (options.files.empty()) {
+      printUsage();
+      return 1;
+    }
+
+    for (const std::string& path : options.files) {
+      MappedFile file(path);
+      Columns columns = parseCapture(file.data(), file.size(), options.threads);
+      printReport(path, analyze(columns, options.threads, options.bins), options);
+      if (options.benchRuns > 0) {
+        benchmark(file, options);
+      }
+    }
+  } catch (const std::exception& error) {
+    std::fprintf(stderr, "TelemetryAnalyzer: %s\n", error.what());
+    return 1;
+  }
+  return 0;
+}